@@ -3,7 +3,14 @@ set(SETTING_DEFAULT_MENU "DefaultMenu")
 set(SETTING_MAX_BUTTONS "MaxButtons")
 set(SETTING_VSYNC "VSync")
 set(SETTING_FPS_LIMIT "FPSLimit")
+set(SETTING_PRECISE_FRAME_PACING "PreciseFramePacing")
 set(SETTING_APPLICATION_TIMEOUT "ApplicationTimeout")
+set(SETTING_LOW_POWER_MODE "LowPowerMode")
+set(SETTING_IDLE_FPS "IdleFPS")
+set(SETTING_ICON_CACHE "IconCache")
+set(SETTING_TEXTURE_BUDGET "TextureBudget")
+set(SETTING_THEME_PACK "ThemePack")
+set(SETTING_FRAME_STATS "FrameStats")
 set(SETTING_WRAP_ENTRIES "WrapEntries")
 set(SETTING_BACKGROUND_MODE "Mode")
 set(SETTING_BACKGROUND_COLOR "Color")
@@ -97,7 +104,13 @@ set(SETTING_GAMEPAD_BUTTON_DPAD_RIGHT "ButtonDPadRight")
 set(DEFAULT_MENU "Main")
 set(DEFAULT_MAX_BUTTONS 4)
 set(DEFAULT_VSYNC "true")
+set(DEFAULT_PRECISE_FRAME_PACING "false")
 set(DEFAULT_APPLICATION_TIMEOUT "15")
+set(DEFAULT_LOW_POWER_MODE "false")
+set(DEFAULT_IDLE_FPS "0")
+set(DEFAULT_ICON_CACHE "true")
+set(DEFAULT_TEXTURE_BUDGET "0")
+set(DEFAULT_FRAME_STATS "false")
 set(DEFAULT_WRAP_ENTRIES "false")
 set(DEFAULT_BACKGROUND_MODE "Color")
 set(DEFAULT_BACKGROUND_COLOR_R "00")
@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <SDL.h>
+#include "launcher.h"
+#include <launcher_config.h>
+#include "atlas.h"
+#include "texture.h"
+#include "util.h"
+#include "debug.h"
+
+// A texture waiting to be packed into an atlas
+typedef struct {
+    SDL_Texture **texture;
+    SDL_Rect *clip;
+    int w;
+    int h;
+    int x;
+    int y;
+    int atlas;
+} AtlasItem;
+
+static void add_item(AtlasItem *items, int *num_items, SDL_Texture **texture, SDL_Rect *clip, int w, int h);
+static void free_entry_texture(MenuPage *page, SDL_Texture **texture);
+
+extern Config config;
+extern SDL_Renderer *renderer;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+static SDL_Vertex vertices[4*MAX_BATCH_QUADS];
+static int indices[6*MAX_BATCH_QUADS];
+static int num_quads = 0;
+static SDL_Texture *batch_texture = NULL;
+#endif
+
+// A function to add a texture to the list of items to pack
+static void add_item(AtlasItem *items, int *num_items, SDL_Texture **texture, SDL_Rect *clip, int w, int h)
+{
+    *clip = (SDL_Rect) {0, 0, 0, 0};
+    if (*texture == NULL)
+        return;
+
+    // Default to drawing the whole texture in case it can't be packed
+    SDL_QueryTexture(*texture, NULL, NULL, &clip->w, &clip->h);
+    items[*num_items] = (AtlasItem) {
+        .texture = texture,
+        .clip = clip,
+        .w = w,
+        .h = h,
+        .x = 0,
+        .y = 0,
+        .atlas = -1
+    };
+    (*num_items)++;
+}
+
+// A function to pack the titles of a menu page into as few textures as possible.
+// Icons are shared between entries with the same image, so they are packed
+// into the shared icon atlases instead
+void create_page_atlas(Menu *menu, unsigned int page)
+{
+    int num_items = 0;
+    unsigned int num_entries = get_page_entries(menu, page);
+    AtlasItem *items = malloc(num_entries * sizeof(AtlasItem));
+    Entry *entry = get_page_entry(menu, page);
+    for (unsigned int i = 0; i < num_entries; i++, entry = entry->next) {
+        if (config.titles_enabled)
+            add_item(items, &num_items, &entry->title_texture, &entry->title_clip, entry->text_rect.w, entry->text_rect.h);
+    }
+    if (num_items == 0 || !SDL_RenderTargetSupported(renderer)) {
+        free(items);
+        return;
+    }
+
+    // Get the maximum atlas size supported by the renderer
+    SDL_RendererInfo info;
+    int max_width = ATLAS_MAX_SIZE;
+    int max_height = ATLAS_MAX_SIZE;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        if (info.max_texture_width > 0)
+            max_width = MIN(max_width, info.max_texture_width);
+        if (info.max_texture_height > 0)
+            max_height = MIN(max_height, info.max_texture_height);
+    }
+
+    // Aim for a roughly square atlas
+    double area = 0.0;
+    int widest = 0;
+    for (int i = 0; i < num_items; i++) {
+        area += (double) (items[i].w + ATLAS_PADDING) * (double) (items[i].h + ATLAS_PADDING);
+        widest = MAX(widest, items[i].w + ATLAS_PADDING);
+    }
+    int atlas_width = MIN(max_width, MAX(widest, (int) ceil(sqrt(area))));
+
+    // Arrange the items in rows, starting a new atlas when the current one is full
+    int *widths = calloc((size_t) num_items, sizeof(int));
+    int *heights = calloc((size_t) num_items, sizeof(int));
+    int num_atlases = 0;
+    int x = 0;
+    int y = 0;
+    int row_height = 0;
+    for (int i = 0; i < num_items; i++) {
+        int w = items[i].w + ATLAS_PADDING;
+        int h = items[i].h + ATLAS_PADDING;
+        if (w > atlas_width || h > max_height)
+            continue;
+        if (x + w > atlas_width) {
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+        if (num_atlases == 0 || y + h > max_height) {
+            num_atlases++;
+            x = 0;
+            y = 0;
+            row_height = 0;
+        }
+        items[i].atlas = num_atlases - 1;
+        items[i].x = x;
+        items[i].y = y;
+        x += w;
+        row_height = MAX(row_height, h);
+        widths[num_atlases - 1] = MAX(widths[num_atlases - 1], x);
+        heights[num_atlases - 1] = MAX(heights[num_atlases - 1], y + h);
+    }
+
+    // Copy the textures into the atlases on the GPU
+    SDL_Texture *target = SDL_GetRenderTarget(renderer);
+    MenuPage *menu_page = &menu->pages[page];
+    menu_page->atlases = malloc((size_t) num_atlases * sizeof(SDL_Texture*));
+    menu_page->num_atlases = 0;
+    for (int a = 0; a < num_atlases; a++) {
+        SDL_Texture *atlas = create_texture(SDL_PIXELFORMAT_ARGB8888,
+                                 SDL_TEXTUREACCESS_TARGET,
+                                 widths[a],
+                                 heights[a]
+                             );
+        if (atlas == NULL) {
+            log_error("Could not create texture atlas for menu '%s'\n%s", menu->name, SDL_GetError());
+            continue;
+        }
+        SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderTarget(renderer, atlas);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        for (int i = 0; i < num_items; i++) {
+            if (items[i].atlas != a)
+                continue;
+            SDL_Rect rect = {items[i].x, items[i].y, items[i].w, items[i].h};
+            SDL_SetTextureBlendMode(*items[i].texture, SDL_BLENDMODE_NONE);
+            SDL_RenderCopy(renderer, *items[i].texture, NULL, &rect);
+            destroy_texture(*items[i].texture);
+            *items[i].texture = atlas;
+            *items[i].clip = rect;
+        }
+        menu_page->atlases[menu_page->num_atlases++] = atlas;
+    }
+    SDL_SetRenderTarget(renderer, target);
+    set_draw_color();
+    if (config.debug)
+        log_debug("Packed %i textures for page %u of menu '%s' into %i atlases",
+            num_items,
+            page,
+            menu->name,
+            menu_page->num_atlases
+        );
+
+    free(widths);
+    free(heights);
+    free(items);
+}
+
+// A function to destroy an entry texture unless it belongs to one of the page's atlases
+static void free_entry_texture(MenuPage *page, SDL_Texture **texture)
+{
+    if (*texture == NULL)
+        return;
+    bool atlas = false;
+    for (int i = 0; i < page->num_atlases && !atlas; i++)
+        atlas = *texture == page->atlases[i];
+    if (!atlas)
+        destroy_texture(*texture);
+    *texture = NULL;
+}
+
+// A function to release the textures of a menu page so it can be rendered again later
+void free_page_textures(Menu *menu, unsigned int page)
+{
+    MenuPage *menu_page = &menu->pages[page];
+    unsigned int num_entries = get_page_entries(menu, page);
+    Entry *entry = get_page_entry(menu, page);
+    for (unsigned int i = 0; i < num_entries; i++, entry = entry->next) {
+        release_shared_texture(entry->icon_shared);
+        release_shared_texture(entry->icon_selected_shared);
+        entry->icon_shared = NULL;
+        entry->icon_selected_shared = NULL;
+        entry->icon = NULL;
+        entry->icon_selected = NULL;
+        free_entry_texture(menu_page, &entry->title_texture);
+    }
+    for (int i = 0; i < menu_page->num_atlases; i++)
+        destroy_texture(menu_page->atlases[i]);
+    free(menu_page->atlases);
+    menu_page->atlases = NULL;
+    menu_page->num_atlases = 0;
+    menu_page->rendered = false;
+}
+
+// A function to queue a texture copy, batching consecutive copies from the same texture
+void batch_copy(SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst)
+{
+    if (texture == NULL)
+        return;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if (texture != batch_texture || num_quads == MAX_BATCH_QUADS)
+        flush_batch();
+    batch_texture = texture;
+
+    int w, h;
+    SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+    float u0 = (float) src->x / (float) w;
+    float v0 = (float) src->y / (float) h;
+    float u1 = (float) (src->x + src->w) / (float) w;
+    float v1 = (float) (src->y + src->h) / (float) h;
+    float x0 = (float) dst->x;
+    float y0 = (float) dst->y;
+    float x1 = (float) (dst->x + dst->w);
+    float y1 = (float) (dst->y + dst->h);
+    SDL_Color color = {0xFF, 0xFF, 0xFF, 0xFF};
+
+    SDL_Vertex *vertex = vertices + 4*num_quads;
+    vertex[0] = (SDL_Vertex) {{x0, y0}, color, {u0, v0}};
+    vertex[1] = (SDL_Vertex) {{x1, y0}, color, {u1, v0}};
+    vertex[2] = (SDL_Vertex) {{x1, y1}, color, {u1, v1}};
+    vertex[3] = (SDL_Vertex) {{x0, y1}, color, {u0, v1}};
+
+    int *index = indices + 6*num_quads;
+    int base = 4*num_quads;
+    index[0] = base;
+    index[1] = base + 1;
+    index[2] = base + 2;
+    index[3] = base + 2;
+    index[4] = base + 3;
+    index[5] = base;
+    num_quads++;
+#else
+    SDL_RenderCopy(renderer, texture, src, dst);
+#endif
+}
+
+// A function to draw all queued texture copies
+void flush_batch()
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if (num_quads > 0)
+        SDL_RenderGeometry(renderer, batch_texture, vertices, 4*num_quads, indices, 6*num_quads);
+    num_quads = 0;
+    batch_texture = NULL;
+#endif
+}
@@ -0,0 +1,8 @@
+#define ATLAS_MAX_SIZE 4096
+#define ATLAS_PADDING 1
+#define MAX_BATCH_QUADS 64
+
+void create_page_atlas(Menu *menu, unsigned int page);
+void free_page_textures(Menu *menu, unsigned int page);
+void batch_copy(SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst);
+void flush_batch(void);
@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <SDL.h>
+#include <SDL_image.h>
+#include "launcher.h"
+#include <launcher_config.h>
+#include "benchmark.h"
+#include "stats.h"
+#include "util.h"
+#include "debug.h"
+
+static void add_command(const char *command);
+static bool compare_frame(SDL_Surface *frame, const char *reference_path);
+
+extern Config config;
+extern SDL_Renderer *renderer;
+extern Geometry geo;
+
+// Benchmark state
+static struct {
+    char **script;
+    int script_length;
+    int script_capacity;
+    int position;
+    int frames;
+    Uint64 start;
+    Uint64 first_frame;
+    Uint64 last_frame;
+} benchmark = {
+    .script = NULL,
+    .script_length = 0,
+    .script_capacity = 0,
+    .position = 0,
+    .frames = 0,
+    .start = 0,
+    .first_frame = 0,
+    .last_frame = 0
+};
+
+// A function to start the benchmark timer when the program starts
+void init_benchmark()
+{
+    benchmark.start = SDL_GetPerformanceCounter();
+}
+
+// A function to override the settings that would interfere with the benchmark,
+// and build the scripted sequence of commands
+void configure_benchmark()
+{
+    config.vsync = false;
+    config.low_power_mode = false;
+    config.idle_fps = 0;
+    config.frame_stats = true;
+    config.screensaver_enabled = false;
+    config.gamepad_enabled = false;
+    free(config.startup_cmd);
+    config.startup_cmd = NULL;
+    free(config.quit_cmd);
+    config.quit_cmd = NULL;
+    if (config.benchmark_frames <= 0)
+        config.benchmark_frames = BENCHMARK_DEFAULT_FRAMES;
+
+    // Scroll through the default menu, then visit every other menu and go back
+    Menu *default_menu = get_menu(config.default_menu);
+    if (default_menu != NULL) {
+        for (unsigned int i = 0; i < default_menu->num_entries; i++)
+            add_command(SCMD_RIGHT);
+    }
+    char *command = NULL;
+    for (Menu *menu = config.first_menu; menu != NULL; menu = menu->next) {
+        if (menu == default_menu || menu->num_entries == 0)
+            continue;
+        sprintf_alloc(&command, "%s %s", SCMD_SUBMENU, menu->name);
+        add_command(command);
+        free(command);
+        command = NULL;
+        for (unsigned int i = 0; i < menu->num_entries; i++)
+            add_command(SCMD_RIGHT);
+        add_command(SCMD_BACK);
+    }
+    if (benchmark.script_length == 0)
+        add_command(SCMD_RIGHT);
+}
+
+// A function to append a command to the benchmark script
+static void add_command(const char *command)
+{
+    if (benchmark.script_length == benchmark.script_capacity) {
+        benchmark.script_capacity = benchmark.script_capacity ? 2*benchmark.script_capacity : 32;
+        benchmark.script = realloc(benchmark.script, (size_t) benchmark.script_capacity * sizeof(char*));
+    }
+    benchmark.script[benchmark.script_length++] = strdup(command);
+}
+
+// A function to free the benchmark script
+void quit_benchmark()
+{
+    for (int i = 0; i < benchmark.script_length; i++)
+        free(benchmark.script[i]);
+    free(benchmark.script);
+    benchmark.script = NULL;
+    benchmark.script_length = 0;
+    benchmark.script_capacity = 0;
+}
+
+// A function to record that a frame was presented
+void count_benchmark_frame()
+{
+    benchmark.last_frame = SDL_GetPerformanceCounter();
+    if (benchmark.frames == 0)
+        benchmark.first_frame = benchmark.last_frame;
+    benchmark.frames++;
+}
+
+// A function to check whether the requested number of frames has been rendered
+bool benchmark_finished()
+{
+    return benchmark.frames >= config.benchmark_frames;
+}
+
+// A function to get the next command in the benchmark script, repeating it as necessary
+const char *next_benchmark_command()
+{
+    const char *command = benchmark.script[benchmark.position];
+    benchmark.position = (benchmark.position + 1) % benchmark.script_length;
+    return command;
+}
+
+// A function to print the results of the benchmark
+void print_benchmark_results(FILE *stream)
+{
+    double frequency = (double) SDL_GetPerformanceFrequency();
+    double first_frame_time = (double) (benchmark.first_frame - benchmark.start) / frequency;
+    double elapsed_time = (double) (benchmark.last_frame - benchmark.first_frame) / frequency;
+    double fps = elapsed_time > 0.0 ? (double) (benchmark.frames - 1) / elapsed_time : 0.0;
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) < 0)
+        info.name = "unknown";
+
+    fprintf(stream, "===================== Benchmark ========================\n");
+    fprintf(stream, "%-25s %s (%ix%i)\n", "Renderer:", info.name, geo.screen_width, geo.screen_height);
+    fprintf(stream, "%-25s %i\n", "Frames:", benchmark.frames);
+    fprintf(stream, "%-25s %i\n", "Script length:", benchmark.script_length);
+    fprintf(stream, "%-25s %.2f ms\n", "Time to first frame:", first_frame_time * 1000.0);
+    fprintf(stream, "%-25s %.2f s\n", "Elapsed time:", elapsed_time);
+    fprintf(stream, "%-25s %.1f\n", "Average FPS:", fps);
+    output_stats(stream);
+}
+
+// A function to compare a frame with a reference image, allowing small differences
+// between renderers
+static bool compare_frame(SDL_Surface *frame, const char *reference_path)
+{
+    SDL_Surface *image = IMG_Load(reference_path);
+    if (image == NULL) {
+        log_error("Could not load reference image %s\n%s", reference_path, IMG_GetError());
+        return false;
+    }
+    SDL_Surface *reference = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(image);
+    if (reference == NULL)
+        return false;
+    if (reference->w != frame->w || reference->h != frame->h) {
+        fprintf(stderr, "Reference image is %ix%i, but the frame is %ix%i\n", reference->w, reference->h, frame->w, frame->h);
+        SDL_FreeSurface(reference);
+        return false;
+    }
+
+    // Count the pixels where any channel differs by more than the tolerance
+    Uint64 mismatched = 0;
+    for (int y = 0; y < frame->h; y++) {
+        const Uint8 *a = (const Uint8*) frame->pixels + y*frame->pitch;
+        const Uint8 *b = (const Uint8*) reference->pixels + y*reference->pitch;
+        for (int x = 0; x < 4*frame->w; x += 4) {
+            if (abs(a[x] - b[x]) > BENCHMARK_PIXEL_TOLERANCE ||
+            abs(a[x + 1] - b[x + 1]) > BENCHMARK_PIXEL_TOLERANCE ||
+            abs(a[x + 2] - b[x + 2]) > BENCHMARK_PIXEL_TOLERANCE ||
+            abs(a[x + 3] - b[x + 3]) > BENCHMARK_PIXEL_TOLERANCE)
+                mismatched++;
+        }
+    }
+    SDL_FreeSurface(reference);
+    double mismatch = (double) mismatched / ((double) frame->w * (double) frame->h);
+    fprintf(stdout, "%-25s %.3f%%\n", "Reference mismatch:", mismatch * 100.0);
+    return mismatch <= BENCHMARK_MAX_MISMATCH;
+}
+
+// A function to save the screenshot and check the results against the reference image
+// and performance budgets given on the command line
+int check_benchmark_results(SDL_Surface *frame)
+{
+    int status = EXIT_SUCCESS;
+    if (config.benchmark_screenshot != NULL && frame != NULL) {
+        if (IMG_SavePNG(frame, config.benchmark_screenshot) < 0) {
+            log_error("Could not save screenshot %s\n%s", config.benchmark_screenshot, IMG_GetError());
+            status = EXIT_FAILURE;
+        }
+    }
+    if (config.benchmark_reference != NULL) {
+        if (frame == NULL || !compare_frame(frame, config.benchmark_reference)) {
+            fprintf(stderr, "FAIL: Frame does not match reference image %s\n", config.benchmark_reference);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    double first_frame_time = (double) (benchmark.first_frame - benchmark.start) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+    if (config.benchmark_max_first_frame > 0.0 && first_frame_time > config.benchmark_max_first_frame) {
+        fprintf(stderr, "FAIL: Time to first frame %.2f ms exceeds budget of %.2f ms\n",
+            first_frame_time,
+            config.benchmark_max_first_frame
+        );
+        status = EXIT_FAILURE;
+    }
+    double draw_time = get_mean_duration(PHASE_DRAW);
+    if (config.benchmark_max_draw > 0.0 && draw_time > config.benchmark_max_draw) {
+        fprintf(stderr, "FAIL: Mean draw time %.2f ms exceeds budget of %.2f ms\n",
+            draw_time,
+            config.benchmark_max_draw
+        );
+        status = EXIT_FAILURE;
+    }
+    return status;
+}
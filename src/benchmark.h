@@ -0,0 +1,17 @@
+#define BENCHMARK_DEFAULT_FRAMES 1000
+#define BENCHMARK_WIDTH 1920
+#define BENCHMARK_HEIGHT 1080
+#define BENCHMARK_REFRESH_RATE 60
+#define BENCHMARK_VIDEO_DRIVER "dummy"
+#define BENCHMARK_RENDER_DRIVER "software"
+#define BENCHMARK_PIXEL_TOLERANCE 2
+#define BENCHMARK_MAX_MISMATCH 0.001
+
+void init_benchmark(void);
+void configure_benchmark(void);
+void quit_benchmark(void);
+void count_benchmark_frame(void);
+bool benchmark_finished(void);
+const char *next_benchmark_command(void);
+void print_benchmark_results(FILE *stream);
+int check_benchmark_results(SDL_Surface *frame);
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_ttf.h>
+#include "launcher.h"
+#include <launcher_config.h>
+#include "cache.h"
+#include "image.h"
+#include "util.h"
+#include "debug.h"
+#include "platform/platform.h"
+
+static Uint64 hash_key(const char *path, Uint64 mtime, Uint64 size, int icon_size);
+static size_t get_pixel_offset(size_t path_length);
+static SDL_Surface *read_cache_file(const char *cache_path, const char *path, Uint64 mtime, Uint64 size, int icon_size);
+static void write_cache_file(const char *cache_path, const char *path, Uint64 mtime, Uint64 size, SDL_Surface *surface);
+
+extern Config config;
+static char cache_directory[MAX_PATH_CHARS + 1];
+
+// A function to find and create the icon cache directory
+void init_icon_cache()
+{
+#ifdef __unix__
+    const char *xdg_cache = getenv("XDG_CACHE_HOME");
+    if (xdg_cache != NULL && xdg_cache[0] != '\0')
+        join_paths(cache_directory, sizeof(cache_directory), 3, xdg_cache, EXECUTABLE_TITLE, "icons");
+    else
+        join_paths(cache_directory, sizeof(cache_directory), 4, getenv("HOME"), ".cache", EXECUTABLE_TITLE, "icons");
+#else
+    join_paths(cache_directory, sizeof(cache_directory), 3, config.exe_path, "cache", "icons");
+#endif
+    make_directory(cache_directory);
+    if (!directory_exists(cache_directory)) {
+        log_error("Could not create icon cache directory %s, disabling icon cache", cache_directory);
+        config.icon_cache = false;
+    }
+    else
+        log_debug("Icon cache directory: %s", cache_directory);
+}
+
+// A function to hash the cache key of an icon with FNV-1a
+static Uint64 hash_key(const char *path, Uint64 mtime, Uint64 size, int icon_size)
+{
+    Uint64 hash = FNV_OFFSET_BASIS;
+    for (const char *p = path; *p != '\0'; p++)
+        hash = (hash ^ (Uint8) *p) * FNV_PRIME;
+    Uint64 values[3] = {mtime, size, (Uint64) icon_size};
+    const Uint8 *bytes = (const Uint8*) values;
+    for (size_t i = 0; i < sizeof(values); i++)
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    return hash;
+}
+
+// A function to get the offset of the pixel data in a cache file
+static size_t get_pixel_offset(size_t path_length)
+{
+    size_t offset = sizeof(IconCacheHeader) + path_length;
+    return (offset + ICON_CACHE_ALIGNMENT - 1) / ICON_CACHE_ALIGNMENT * ICON_CACHE_ALIGNMENT;
+}
+
+// A function to load an icon decoded and scaled to the icon size, using the cache if possible.
+// This is safe to call from worker threads
+SDL_Surface *load_cached_icon(const char *path, int size)
+{
+    Uint64 mtime, file_size;
+    if (path == NULL)
+        return NULL;
+    if (!get_file_info(path, &mtime, &file_size))
+        return decode_icon(path, size);
+
+    char filename[17 + sizeof(ICON_CACHE_EXTENSION)];
+    char cache_path[MAX_PATH_CHARS + 1];
+    snprintf(filename, sizeof(filename), "%016" PRIx64 ICON_CACHE_EXTENSION, hash_key(path, mtime, file_size, size));
+    join_paths(cache_path, sizeof(cache_path), 2, cache_directory, filename);
+
+    // Warm start: copy the decoded pixels straight from the mapped cache file
+    SDL_Surface *surface = read_cache_file(cache_path, path, mtime, file_size, size);
+    if (surface != NULL)
+        return surface;
+
+    // Cold start: decode and scale the image, then store it in the cache
+    surface = decode_icon(path, size);
+    if (surface != NULL)
+        write_cache_file(cache_path, path, mtime, file_size, surface);
+    return surface;
+}
+
+// A function to create a surface from a cache file if it is valid for the icon
+static SDL_Surface *read_cache_file(const char *cache_path, const char *path, Uint64 mtime, Uint64 size, int icon_size)
+{
+    size_t map_size = 0;
+    Uint8 *data = map_file(cache_path, &map_size);
+    if (data == NULL)
+        return NULL;
+
+    // Validate the header in case of a hash collision or stale file
+    SDL_Surface *surface = NULL;
+    const IconCacheHeader *header = (const IconCacheHeader*) data;
+    size_t path_length = strlen(path);
+    if (map_size >= sizeof(IconCacheHeader) &&
+    header->magic == ICON_CACHE_MAGIC &&
+    header->version == ICON_CACHE_VERSION &&
+    header->mtime == mtime &&
+    header->size == size &&
+    header->width == icon_size &&
+    header->height == icon_size &&
+    header->format == SDL_PIXELFORMAT_ARGB8888 &&
+    header->path_length == path_length &&
+    map_size >= get_pixel_offset(path_length) + (size_t) icon_size * (size_t) icon_size * 4 &&
+    !memcmp(data + sizeof(IconCacheHeader), path, path_length)) {
+        SDL_Surface *mapped = SDL_CreateRGBSurfaceWithFormatFrom(data + get_pixel_offset(path_length),
+                                  header->width,
+                                  header->height,
+                                  32,
+                                  header->width * 4,
+                                  header->format
+                              );
+        if (mapped != NULL) {
+            surface = SDL_DuplicateSurface(mapped);
+            SDL_FreeSurface(mapped);
+        }
+    }
+    unmap_file(data, map_size);
+    return surface;
+}
+
+// A function to write a decoded icon to a cache file
+static void write_cache_file(const char *cache_path, const char *path, Uint64 mtime, Uint64 size, SDL_Surface *surface)
+{
+    // Write to a temporary file first so a partially written file is never read.
+    // The thread ID keeps workers decoding the same icon from sharing a file
+    char tmp_path[MAX_PATH_CHARS + 1];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%lu.tmp", cache_path, SDL_ThreadID());
+    FILE *file = fopen(tmp_path, "wb");
+    if (file == NULL) {
+        log_error("Could not write icon cache file %s", tmp_path);
+        return;
+    }
+    size_t path_length = strlen(path);
+    IconCacheHeader header = {
+        .magic = ICON_CACHE_MAGIC,
+        .version = ICON_CACHE_VERSION,
+        .mtime = mtime,
+        .size = size,
+        .width = surface->w,
+        .height = surface->h,
+        .format = surface->format->format,
+        .path_length = (Uint32) path_length
+    };
+    static const Uint8 padding[ICON_CACHE_ALIGNMENT] = {0};
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(path, 1, path_length, file) == path_length;
+    size_t padding_length = get_pixel_offset(path_length) - sizeof(header) - path_length;
+    success = success && fwrite(padding, 1, padding_length, file) == padding_length;
+    for (int y = 0; success && y < surface->h; y++)
+        success = fwrite((Uint8*) surface->pixels + y*surface->pitch, 4, (size_t) surface->w, file) == (size_t) surface->w;
+    fclose(file);
+
+    if (success) {
+        remove(cache_path);
+        rename(tmp_path, cache_path);
+    }
+    else {
+        log_error("Could not write icon cache file %s", cache_path);
+        remove(tmp_path);
+    }
+}
@@ -0,0 +1,21 @@
+#define ICON_CACHE_MAGIC 0x43494C46 // "FLIC"
+#define ICON_CACHE_VERSION 2
+#define ICON_CACHE_ALIGNMENT 16
+#define ICON_CACHE_EXTENSION ".bin"
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+// Header at the start of each cached icon file
+typedef struct {
+    Uint32 magic;
+    Uint32 version;
+    Uint64 mtime;
+    Uint64 size;
+    Sint32 width;
+    Sint32 height;
+    Uint32 format;
+    Uint32 path_length;
+} IconCacheHeader;
+
+void init_icon_cache(void);
+SDL_Surface *load_cached_icon(const char *path, int size);
@@ -10,6 +10,7 @@
 #include <launcher_config.h>
 #include "util.h"
 #include "image.h"
+#include "texture.h"
 #include "clock.h"
 #include "debug.h"
 #include "platform/platform.h"
@@ -19,10 +20,11 @@ static void calculate_clock_geometry(Clock *clk);
 static void format_time(Clock *clk);
 static void format_date(Clock *clk);
 static void calculate_clock_positioning(Clock *clk);
+static SDL_Texture *update_clock_texture(SDL_Texture *texture, SDL_Surface *surface);
 
 extern Config config;
-extern State state;
 extern Geometry geo;
+extern SDL_mutex *font_mutex;
 
 // A function to calculate height and x offset of text
 static void calculate_text_metrics(TTF_Font *font, const char *text, int *h, int *x_offset)
@@ -99,7 +101,10 @@ void get_time(Clock *clk)
     }
 
     // Get current time
-    time(&clk->current_time);
+    if (config.benchmark_time)
+        clk->current_time = (time_t) config.benchmark_time;
+    else
+        time(&clk->current_time);
     clk->time_info = localtime(&clk->current_time);
     
     // Set render flags if time and/or date changed
@@ -110,6 +115,13 @@ void get_time(Clock *clk)
     }
 }
 
+// A function to get the number of milliseconds until the displayed time changes
+Uint32 get_time_until_update()
+{
+    time_t current_time = time(NULL);
+    return (Uint32) (60 - current_time % 60) * 1000;
+}
+
 // A function to format the current time according to user settings
 static void format_time(Clock *clk)
 {
@@ -229,20 +241,24 @@ void init_clock(Clock *clk)
     }
 
     // Render the time and date
+    clk->time_texture = NULL;
+    clk->date_texture = NULL;
     format_time(clk);
-    clk->time_texture = render_text_texture(clk->time_string,
+    clk->time_surface = render_text(clk->time_string,
                             &clk->text_info,
                             &clk->time_rect,
                             NULL
                         );
+    clk->date_surface = NULL;
     if (config.clock_show_date) {
         format_date(clk);
-        clk->date_texture = render_text_texture(clk->date_string,
+        clk->date_surface = render_text(clk->date_string,
                                 &clk->text_info,
                                 &clk->date_rect,
                                 NULL
                             );
     }
+    update_clock_textures(clk);
 
     // Calculate geometry
     calculate_clock_geometry(clk);
@@ -251,7 +267,8 @@ void init_clock(Clock *clk)
     clk->render_date = false;
 }
 
-// A function to render the time to image
+// A function to render the time to image. This is safe to call from a worker
+// thread on a copy of the clock
 void render_clock(Clock *clk)
 {
     format_time(clk);
@@ -267,19 +284,44 @@ void render_clock(Clock *clk)
                                 &clk->date_rect,
                                 NULL
                             );
+        SDL_LockMutex(font_mutex);
         calculate_clock_geometry(clk);
+        SDL_UnlockMutex(font_mutex);
     }
     calculate_clock_positioning(clk);
-    state.clock_ready = true;
 }
 
-// A functio nto render the time to image in a separate thread
-int render_clock_async(void *data)
+// A function to copy text into a clock texture in place. A larger texture
+// is only created when the text has outgrown the current one, with room to
+// spare so that it lasts for the following updates
+static SDL_Texture *update_clock_texture(SDL_Texture *texture, SDL_Surface *surface)
 {
-    Clock *clk = (Clock*) data;
-    render_clock(clk);
-    return 0;
-} 
+    if (surface == NULL)
+        return texture;
+    int w = 0;
+    int h = 0;
+    if (texture != NULL)
+        SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+    if (surface->w > w || surface->h > h) {
+        destroy_texture(texture);
+        texture = create_streaming_texture(MAX(w, (int) (CLOCK_TEXTURE_HEADROOM * (float) surface->w)),
+                      MAX(h, surface->h)
+                  );
+    }
+    SDL_Rect rect;
+    update_streaming_texture(texture, surface, &rect);
+    return texture;
+}
+
+// A function to upload the rendered clock text to its textures, which are
+// reused from one update to the next. Must be called from the main thread
+void update_clock_textures(Clock *clk)
+{
+    clk->time_texture = update_clock_texture(clk->time_texture, clk->time_surface);
+    clk->time_surface = NULL;
+    clk->date_texture = update_clock_texture(clk->date_texture, clk->date_surface);
+    clk->date_surface = NULL;
+}
 
 // A function to get the time format for a region
 TimeFormat get_time_format(const char *region)
@@ -1,5 +1,6 @@
 #define MAX_CLOCK_CHARS 20
 #define CLOCK_SPACING_FACTOR 0.5F
+#define CLOCK_TEXTURE_HEADROOM 1.25F // Width of a clock texture relative to its first text
 
 // Clock
 typedef struct {
@@ -9,6 +10,8 @@ typedef struct {
     SDL_Texture *date_texture;
     SDL_Rect time_rect;
     SDL_Rect date_rect;
+    SDL_Rect previous_time_rect;
+    SDL_Rect previous_date_rect;
     TextInfo text_info;
     time_t current_time;
     struct tm *time_info;
@@ -26,7 +29,8 @@ typedef struct {
 
 void init_clock(Clock *clk);
 void get_time(Clock *clk);
+Uint32 get_time_until_update(void);
 void render_clock(Clock *clk);
-int render_clock_async(void *data);
+void update_clock_textures(Clock *clk);
 TimeFormat get_time_format(const char *region);
 DateFormat get_date_format(const char *region);
@@ -17,6 +17,7 @@ static int init_log(void);
 
 extern Config config;
 extern FILE *log_file;
+static SDL_mutex *log_mutex = NULL; // Serializes log output once worker threads are running
 
 // A function to initialize the logging subsystem
 static int init_log()
@@ -58,29 +59,63 @@ void output_log(LogLevel log_level, const char *format, ...)
     if (log_level == LOGLEVEL_DEBUG && !config.debug)
         return;
 
-    // Initialize logging if not already initialized
-    if (log_file == NULL)
-        init_log();
-    
-    // Output log
-    static char buffer[MAX_LOG_LINE_BYTES];
+    // Format the line before taking the lock, truncating it to the buffer size
+    char buffer[MAX_LOG_LINE_BYTES];
     va_list args;
     va_start(args, format);
-    size_t length = (size_t) vsnprintf(buffer, MAX_LOG_LINE_BYTES - 1, format, args);
+    int rc = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    size_t length = rc < 0 ? 0 : MIN((size_t) rc, sizeof(buffer) - 1);
+
+    // Initialize logging if not already initialized, then output the line
+    if (log_mutex != NULL)
+        SDL_LockMutex(log_mutex);
+    if (log_file == NULL)
+        init_log();
     fwrite(buffer, 1, length, log_file);
     if (config.debug)
         fflush(log_file);
-    
 #ifdef __unix__
-    if (log_level > LOGLEVEL_DEBUG)
+    if (log_level > LOGLEVEL_INFO)
         fputs(buffer, stderr);
 #endif
-    va_end(args);
+    if (log_mutex != NULL)
+        SDL_UnlockMutex(log_mutex);
 
     if (log_level == LOGLEVEL_FATAL)
         quit(EXIT_FAILURE);
 }
 
+// A function to write any buffered log output to the log file
+void flush_log()
+{
+    if (log_mutex != NULL)
+        SDL_LockMutex(log_mutex);
+    if (log_file != NULL)
+        fflush(log_file);
+    if (log_mutex != NULL)
+        SDL_UnlockMutex(log_mutex);
+}
+
+// A function to create the log lock. This must be called before any thread
+// other than the main thread can write to the log
+void init_log_mutex()
+{
+    log_mutex = SDL_CreateMutex();
+    if (log_mutex == NULL)
+        log_fatal("Could not create log mutex\n%s", SDL_GetError());
+}
+
+// A function to close the log file after every other thread has quit
+void quit_log()
+{
+    if (log_file != NULL)
+        fclose(log_file);
+    log_file = NULL;
+    SDL_DestroyMutex(log_mutex);
+    log_mutex = NULL;
+}
+
 void print_compiler_info(FILE *stream)
 {
     fputs("Build date: " __DATE__ "\n", stream);
@@ -100,7 +135,14 @@ void debug_settings()
     DEBUG_STR(SETTING_DEFAULT_MENU, config.default_menu);
     DEBUG_BOOL(SETTING_VSYNC, config.vsync);
     DEBUG_INT(SETTING_FPS_LIMIT, config.fps_limit);
+    DEBUG_BOOL(SETTING_PRECISE_FRAME_PACING, config.precise_frame_pacing);
     DEBUG_INT(SETTING_APPLICATION_TIMEOUT, config.application_timeout / 1000);
+    DEBUG_BOOL(SETTING_LOW_POWER_MODE, config.low_power_mode);
+    DEBUG_INT(SETTING_IDLE_FPS, config.idle_fps);
+    DEBUG_BOOL(SETTING_ICON_CACHE, config.icon_cache);
+    DEBUG_INT(SETTING_TEXTURE_BUDGET, (int) (config.texture_budget / (1024 * 1024)));
+    DEBUG_STR(SETTING_THEME_PACK, config.theme_pack);
+    DEBUG_BOOL(SETTING_FRAME_STATS, config.frame_stats);
     DEBUG_MODE(SETTING_ON_LAUNCH, MODE_SETTING_ON_LAUNCH, config.on_launch);
     DEBUG_BOOL(SETTING_WRAP_ENTRIES, config.wrap_entries);
     DEBUG_BOOL(SETTING_RESET_ON_BACK, config.reset_on_back);
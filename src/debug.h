@@ -1,10 +1,14 @@
 typedef enum {
     LOGLEVEL_DEBUG = 0,
+    LOGLEVEL_INFO,
     LOGLEVEL_ERROR,
     LOGLEVEL_FATAL
 } LogLevel;
 
 void output_log(LogLevel log_level, const char *format, ...);
+void flush_log(void);
+void init_log_mutex(void);
+void quit_log(void);
 void print_compiler_info(FILE *stream);
 void debug_video(SDL_Renderer *renderer, SDL_DisplayMode *display_mode);
 void debug_settings(void);
@@ -21,6 +25,7 @@ void debug_button_positions(Entry *entry, Menu *current_menu, Geometry *geo);
 #endif
 
 #define log_debug(msg, ...) output_log(LOGLEVEL_DEBUG, msg endline, ##__VA_ARGS__)
+#define log_info(msg, ...) output_log(LOGLEVEL_INFO, msg endline, ##__VA_ARGS__)
 #define log_error(msg, ...) output_log(LOGLEVEL_ERROR, "" msg endline, ##__VA_ARGS__)
 #define log_fatal(msg, ...) output_log(LOGLEVEL_FATAL, "" msg endline, ##__VA_ARGS__)
 
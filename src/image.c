@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <math.h>
 #include <SDL.h>
 #include <SDL_image.h>
@@ -10,6 +11,11 @@
 #include "image.h"
 #include "util.h"
 #include "debug.h"
+#include "cache.h"
+#include "texture.h"
+#include "jobs.h"
+#include "pack.h"
+#include "pixels.h"
 #include <ini.h>
 #define NANOSVG_IMPLEMENTATION
 #include <nanosvg.h>
@@ -17,30 +23,97 @@
 #include <nanosvgrast.h>
 
 extern Config config;
-extern State state;
 extern SDL_Renderer *renderer;
-extern SDL_Texture *background_texture;
-NSVGrasterizer *rasterizer = NULL;
+extern SDL_mutex *font_mutex;
+extern Geometry geo;
+
+static bool is_svg(const char *path);
+static NSVGimage *get_svg_image(const char *path);
+static SDL_Surface *rasterize_svg_icon(NSVGimage *image, int size);
+static Uint32 clamp_channel(float value);
+static SDL_Surface *reduce_surface(SDL_Surface *surface, int factor);
+static NSVGrasterizer *acquire_rasterizer(void);
+static void release_rasterizer(NSVGrasterizer *rasterizer);
+static SDL_mutex *svg_mutex = NULL; // Guards the SVG image cache
+static SVGImage *svg_images = NULL;
+static SDL_mutex *rasterizer_mutex = NULL; // Guards the rasterizer pool
+static NSVGrasterizer *rasterizers[MAX_RASTERIZERS]; // Idle rasterizers
+static int num_rasterizers = 0;
 
 // A function to initalize SVG rasterization
 int init_svg()
 {
-    rasterizer = nsvgCreateRasterizer();
+    svg_mutex = SDL_CreateMutex();
+    rasterizer_mutex = SDL_CreateMutex();
+    if (svg_mutex == NULL || rasterizer_mutex == NULL) {
+        log_fatal("Could not initialize SVG rasterizer.");
+        return 1;
+    }
+
+    // Create the first rasterizer up front so that a failure is fatal at startup
+    NSVGrasterizer *rasterizer = nsvgCreateRasterizer();
     if (rasterizer == NULL) {
         log_fatal("Could not initialize SVG rasterizer.");
         return 1;
     }
+    release_rasterizer(rasterizer);
     return 0;
 }
 
 // A function to quit the SVG subsystem
 void quit_svg()
 {
-    nsvgDeleteRasterizer(rasterizer);
+    for (int i = 0; i < num_rasterizers; i++)
+        nsvgDeleteRasterizer(rasterizers[i]);
+    num_rasterizers = 0;
+    SDL_DestroyMutex(rasterizer_mutex);
+    SDL_DestroyMutex(svg_mutex);
+    SVGImage *svg = svg_images;
+    while (svg != NULL) {
+        SVGImage *next = svg->next;
+        nsvgDelete(svg->image);
+        free(svg->path);
+        free(svg);
+        svg = next;
+    }
+    svg_images = NULL;
+}
+
+// A function to take an idle rasterizer from the pool, or create one if every
+// rasterizer is in use by another thread. Rasterizers keep scratch buffers
+// between images, so each thread only ever holds one at a time
+static NSVGrasterizer *acquire_rasterizer()
+{
+    NSVGrasterizer *rasterizer = NULL;
+    SDL_LockMutex(rasterizer_mutex);
+    if (num_rasterizers)
+        rasterizer = rasterizers[--num_rasterizers];
+    SDL_UnlockMutex(rasterizer_mutex);
+    if (rasterizer == NULL) {
+        rasterizer = nsvgCreateRasterizer();
+        if (rasterizer == NULL)
+            log_error("Could not create SVG rasterizer");
+    }
+    return rasterizer;
+}
+
+// A function to return a rasterizer to the pool
+static void release_rasterizer(NSVGrasterizer *rasterizer)
+{
+    SDL_LockMutex(rasterizer_mutex);
+    if (num_rasterizers < MAX_RASTERIZERS) {
+        rasterizers[num_rasterizers++] = rasterizer;
+        rasterizer = NULL;
+    }
+    SDL_UnlockMutex(rasterizer_mutex);
+    if (rasterizer != NULL)
+        nsvgDeleteRasterizer(rasterizer);
 }
 
-// A function to load the next slideshow background from the struct
-SDL_Surface *load_next_slideshow_background(Slideshow *slideshow, bool transition)
+// A function to decode the next slideshow image that can be loaded, skipping any
+// that fail. Returns NULL if no image could be loaded, and sets single if every
+// other image failed. This is safe to call from a worker thread
+SDL_Surface *load_next_slideshow_background(Slideshow *slideshow, bool *single)
 {
     SDL_Surface *surface = NULL;
     int initial_index = slideshow->i;
@@ -50,62 +123,17 @@ SDL_Surface *load_next_slideshow_background(Slideshow *slideshow, bool transitio
         (slideshow->i)++;
         if (slideshow->i >= slideshow->num_images)
             slideshow->i = 0;
-        surface = IMG_Load(slideshow->images[slideshow->order[slideshow->i]]);
-        
-        // If the loaded image has no alpha channel (e.g. JPEG), create one 
-        // so that we can have transparency for the background transition
-        if (surface != NULL && surface->format->format == SDL_PIXELFORMAT_RGB24 && transition) {
-            SDL_Surface *tmp = SDL_CreateRGBSurfaceWithFormat(0,
-                                   surface->w,
-                                   surface->h,
-                                   32,
-                                   SDL_PIXELFORMAT_ARGB8888
-                                );
-            Uint32 color = SDL_MapRGBA(tmp->format, 0, 0, 0, 0xFF);
-            SDL_FillRect(tmp, NULL, color);
-            SDL_BlitSurface(surface, NULL, tmp, NULL);
-            SDL_FreeSurface(surface);
-            surface = tmp;
-            attempts++;
-        } 
-    } while (surface == NULL && slideshow->i != initial_index && attempts < slideshow->num_images);
-    
-    // Switch to color background mode if we failed to load any image from the array
-    if (surface == NULL) {
-        log_error(
-            "Could not load any image from slideshow directory %s\n"
-            "Changing background to color mode", 
-            config.slideshow_directory
-        );
-        quit_slideshow();
-        config.background_mode = BACKGROUND_COLOR;
-        set_draw_color();
-    }
+        surface = load_background_image(slideshow->images[slideshow->order[slideshow->i]],
+                      geo.screen_width,
+                      geo.screen_height
+                  );
+        attempts++;
 
-    // If only one image in the entire slideshow array was valid, switch to
-    // single image background mode
-    else if (slideshow->i == initial_index && surface != NULL) {
-        log_error(
-            "Could only load one image from slideshow directory %s\n"
-            "Changing background to single image mode",
-            config.slideshow_directory
-        );
-        background_texture = SDL_CreateTextureFromSurface(renderer, surface);
-        config.background_mode = BACKGROUND_IMAGE;
-    }
+    } while (surface == NULL && slideshow->i != initial_index && attempts < slideshow->num_images);
+    *single = surface != NULL && slideshow->i == initial_index;
     return surface;
 }
 
-// A function to load a new slideshow background in a separate thread
-int load_next_slideshow_background_async(void *data)
-{
-    Slideshow *slideshow = (Slideshow*) data;
-    slideshow->transition_surface = load_next_slideshow_background(slideshow, true);
-    state.slideshow_background_rendering = false;
-    state.slideshow_background_ready = true;
-    return 0;
-}
-
 // A function to load a texture from a file
 SDL_Texture *load_texture_from_file(const char *path)
 {
@@ -126,6 +154,296 @@ SDL_Texture *load_texture_from_file(const char *path)
     return texture;
 }
 
+// A function to load an icon into a surface, from the theme pack or icon cache if enabled.
+// This is safe to call from worker threads
+SDL_Surface *load_icon(const char *path)
+{
+    if (path == NULL)
+        return NULL;
+    SDL_Surface *surface = load_pack_asset(PACK_ASSET_ICON, path, NULL);
+    if (surface != NULL)
+        return surface;
+    if (config.icon_cache)
+        return load_cached_icon(path, config.icon_size);
+    return decode_icon(path, config.icon_size);
+}
+
+// A function to decode an icon at the icon size. Raster images are resampled once,
+// rather than scaled on every draw, and SVGs are rasterized directly at the icon size
+SDL_Surface *decode_icon(const char *path, int size)
+{
+    if (is_svg(path)) {
+        NSVGimage *image = get_svg_image(path);
+        return image != NULL ? rasterize_svg_icon(image, size) : NULL;
+    }
+    SDL_Surface *image = IMG_Load(path);
+    if (image == NULL) {
+        log_error("Could not load image %s\n%s", path, IMG_GetError());
+        return NULL;
+    }
+    if (image->w == size && image->h == size)
+        return image;
+    SDL_Surface *surface = scale_surface(image, size, size);
+    if (surface == NULL)
+        return image;
+    SDL_FreeSurface(image);
+    return surface;
+}
+
+// A function to determine if a file is an SVG image from its extension
+static bool is_svg(const char *path)
+{
+    size_t length = strlen(path);
+    return length > LEN(EXT_SVG) && !SDL_strcasecmp(path + length - LEN(EXT_SVG), EXT_SVG);
+}
+
+// A function to get a parsed SVG image, parsing the file if it is not already cached
+static NSVGimage *get_svg_image(const char *path)
+{
+    SVGImage *svg;
+    SDL_LockMutex(svg_mutex);
+    for (svg = svg_images; svg != NULL && strcmp(svg->path, path); svg = svg->next);
+    SDL_UnlockMutex(svg_mutex);
+    if (svg != NULL)
+        return svg->image;
+
+    // Parse outside the lock so that other workers can use the cache meanwhile
+    NSVGimage *image = nsvgParseFromFile(path, "px", 96.0f);
+    if (image == NULL) {
+        log_error("Could not load SVG image %s", path);
+        return NULL;
+    }
+    SDL_LockMutex(svg_mutex);
+    for (svg = svg_images; svg != NULL && strcmp(svg->path, path); svg = svg->next);
+    if (svg == NULL) {
+        svg = malloc(sizeof(SVGImage));
+        svg->path = strdup(path);
+        svg->image = image;
+        svg->next = svg_images;
+        svg_images = svg;
+    }
+    else
+        nsvgDelete(image);
+    SDL_UnlockMutex(svg_mutex);
+    return svg->image;
+}
+
+// A function to rasterize a parsed SVG image into a square surface, scaled to fit
+// and centered so that icons with a non-square view box are not distorted
+static SDL_Surface *rasterize_svg_icon(NSVGimage *image, int size)
+{
+    if (image->width <= 0.0f || image->height <= 0.0f) {
+        log_error("SVG image has no size");
+        return NULL;
+    }
+    SDL_Surface *surface = SDL_CreateRGBSurface(0, size, size, 32, COLOR_MASKS);
+    if (surface == NULL)
+        return NULL;
+    float scale = MIN((float) size / image->width, (float) size / image->height);
+    float x = ((float) size - image->width * scale) / 2.0f;
+    float y = ((float) size - image->height * scale) / 2.0f;
+    NSVGrasterizer *rasterizer = acquire_rasterizer();
+    if (rasterizer == NULL) {
+        SDL_FreeSurface(surface);
+        return NULL;
+    }
+    nsvgRasterize(rasterizer, image, x, y, scale, surface->pixels, size, size, surface->pitch);
+    release_rasterizer(rasterizer);
+    return surface;
+}
+
+// A function to round and clamp a filtered value to a color channel
+static Uint32 clamp_channel(float value)
+{
+    if (value <= 0.0F)
+        return 0;
+    if (value >= 255.0F)
+        return 255;
+    return (Uint32) (value + 0.5F);
+}
+
+// A function to resample a surface with a separable Lanczos filter. Colors are
+// filtered premultiplied by alpha so transparent pixels don't darken the edges.
+// The source is converted one row at a time, so that a large photo is never
+// copied at full size. The filter loops run in the SIMD pixel kernels
+SDL_Surface *scale_surface(SDL_Surface *surface, int width, int height)
+{
+    // SDL_ConvertPixels can't convert from a palette, so expand paletted images first
+    SDL_Surface *converted = NULL;
+    if (SDL_ISPIXELFORMAT_INDEXED(surface->format->format)) {
+        converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+        if (converted == NULL)
+            return NULL;
+        surface = converted;
+    }
+    bool convert = surface->format->format != SDL_PIXELFORMAT_ARGB8888;
+    SDL_Surface *output = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    FilterWeights horizontal, vertical;
+    bool weights = output != NULL && calculate_filter_weights(&horizontal, surface->w, width);
+    if (weights && !calculate_filter_weights(&vertical, surface->h, height)) {
+        free_filter_weights(&horizontal);
+        weights = false;
+    }
+    Uint32 *source_row = convert ? malloc((size_t) surface->w * sizeof(Uint32)) : NULL;
+    float *row = malloc((size_t) MAX(surface->w, width) * 4 * sizeof(float));
+    float *window = weights ? malloc((size_t) width * (size_t) vertical.max_count * 4 * sizeof(float)) : NULL;
+    if (!weights || (convert && source_row == NULL) || row == NULL || window == NULL) {
+        if (weights) {
+            free_filter_weights(&horizontal);
+            free_filter_weights(&vertical);
+        }
+        free(source_row);
+        free(row);
+        free(window);
+        SDL_FreeSurface(output);
+        SDL_FreeSurface(converted);
+        return NULL;
+    }
+
+    // Filter each output row from a rolling window of the source rows it needs.
+    // The windows only move down, so each source row is filtered horizontally once
+    int next = 0;
+    for (int y = 0; y < height; y++) {
+        // Horizontal pass: premultiply the next source rows and filter them to the output width
+        for (; next < vertical.start[y] + vertical.count[y]; next++) {
+            const Uint32 *pixels = (const Uint32*) ((const Uint8*) surface->pixels + next*surface->pitch);
+            if (convert) {
+                SDL_ConvertPixels(surface->w, 1, surface->format->format, pixels, surface->pitch,
+                    SDL_PIXELFORMAT_ARGB8888, source_row, surface->w * 4);
+                pixels = source_row;
+            }
+            for (int x = 0; x < surface->w; x++) {
+                float alpha = (float) (pixels[x] >> 24);
+                float premultiply = alpha / 255.0F;
+                row[4*x] = (float) ((pixels[x] >> 16) & 0xFF) * premultiply;
+                row[4*x + 1] = (float) ((pixels[x] >> 8) & 0xFF) * premultiply;
+                row[4*x + 2] = (float) (pixels[x] & 0xFF) * premultiply;
+                row[4*x + 3] = alpha;
+            }
+            resample_row(row, window + (size_t) (next % vertical.max_count) * (size_t) width * 4, &horizontal, width);
+        }
+
+        // Vertical pass: accumulate the filtered rows, then unpremultiply into the output
+        const float *weight = vertical.weights + y*vertical.max_count;
+        for (int i = 0; i < width * 4; i++)
+            row[i] = 0.0F;
+        for (int i = 0; i < vertical.count[y]; i++) {
+            const float *in = window + (size_t) ((vertical.start[y] + i) % vertical.max_count) * (size_t) width * 4;
+            accumulate_row(in, row, weight[i], width * 4);
+        }
+        Uint32 *out = (Uint32*) ((Uint8*) output->pixels + y*output->pitch);
+        for (int x = 0; x < width; x++) {
+            Uint32 alpha = clamp_channel(row[4*x + 3]);
+            if (alpha == 0)
+                out[x] = 0;
+            else {
+                float unpremultiply = 255.0F / (float) alpha;
+                out[x] = alpha << 24 |
+                         clamp_channel(row[4*x] * unpremultiply) << 16 |
+                         clamp_channel(row[4*x + 1] * unpremultiply) << 8 |
+                         clamp_channel(row[4*x + 2] * unpremultiply);
+            }
+        }
+    }
+
+    free_filter_weights(&horizontal);
+    free_filter_weights(&vertical);
+    free(source_row);
+    free(row);
+    free(window);
+    SDL_FreeSurface(converted);
+    return output;
+}
+
+// A function to shrink a surface by an integer factor, averaging each block of
+// pixels. The source is converted one row at a time, so that a large photo is
+// never copied at full size
+static SDL_Surface *reduce_surface(SDL_Surface *surface, int factor)
+{
+    if (SDL_ISPIXELFORMAT_INDEXED(surface->format->format))
+        return NULL;
+    int width = (surface->w + factor - 1) / factor;
+    int height = (surface->h + factor - 1) / factor;
+    SDL_Surface *output = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    Uint32 *row = malloc((size_t) surface->w * sizeof(Uint32));
+    Uint64 *sums = malloc((size_t) width * 4 * sizeof(Uint64));
+    if (output == NULL || row == NULL || sums == NULL) {
+        SDL_FreeSurface(output);
+        free(row);
+        free(sums);
+        return NULL;
+    }
+
+    for (int y = 0; y < height; y++) {
+        // Accumulate premultiplied channels of every source row in the block
+        int rows = MIN(factor, surface->h - y*factor);
+        memset(sums, 0, (size_t) width * 4 * sizeof(Uint64));
+        for (int i = 0; i < rows; i++) {
+            const Uint8 *pixels = (const Uint8*) surface->pixels + (y*factor + i)*surface->pitch;
+            SDL_ConvertPixels(surface->w, 1, surface->format->format, pixels, surface->pitch,
+                SDL_PIXELFORMAT_ARGB8888, row, surface->w * 4);
+            for (int x = 0; x < surface->w; x++) {
+                Uint64 *sum = sums + 4*(x / factor);
+                Uint64 alpha = row[x] >> 24;
+                sum[0] += alpha;
+                sum[1] += ((row[x] >> 16) & 0xFF) * alpha;
+                sum[2] += ((row[x] >> 8) & 0xFF) * alpha;
+                sum[3] += (row[x] & 0xFF) * alpha;
+            }
+        }
+
+        // Average each block, then unpremultiply into the output
+        Uint32 *out = (Uint32*) ((Uint8*) output->pixels + y*output->pitch);
+        for (int x = 0; x < width; x++) {
+            const Uint64 *sum = sums + 4*x;
+            Uint64 count = (Uint64) rows * (Uint64) MIN(factor, surface->w - x*factor);
+            if (sum[0] == 0)
+                out[x] = 0;
+            else {
+                out[x] = (Uint32) ((sum[0] + count / 2) / count) << 24 |
+                         (Uint32) ((sum[1] + sum[0] / 2) / sum[0]) << 16 |
+                         (Uint32) ((sum[2] + sum[0] / 2) / sum[0]) << 8 |
+                         (Uint32) ((sum[3] + sum[0] / 2) / sum[0]);
+            }
+        }
+    }
+    free(row);
+    free(sums);
+    return output;
+}
+
+// A function to decode a background image and scale it down for the screen. The
+// background is stretched to fill the screen, so the image keeps its aspect ratio
+// and covers the screen on both axes, and the stretch never upscales it. This is
+// safe to call from worker threads
+SDL_Surface *load_background_image(const char *path, int width, int height)
+{
+    SDL_Surface *image = IMG_Load(path);
+    if (image == NULL)
+        return NULL;
+    double scale = MAX((double) width / (double) image->w, (double) height / (double) image->h);
+    if (scale >= 1.0)
+        return image;
+    int output_width = MAX(1, (int) ceil((double) image->w * scale));
+    int output_height = MAX(1, (int) ceil((double) image->h * scale));
+
+    // Average blocks of pixels first when shrinking a lot, so that the Lanczos
+    // filter only has to shrink the image by less than a factor of two
+    int factor = MIN(image->w / output_width, image->h / output_height);
+    if (factor >= 2) {
+        SDL_Surface *reduced = reduce_surface(image, factor);
+        if (reduced != NULL) {
+            SDL_FreeSurface(image);
+            image = reduced;
+        }
+    }
+    SDL_Surface *surface = scale_surface(image, output_width, output_height);
+    if (surface == NULL)
+        return image;
+    SDL_FreeSurface(image);
+    return surface;
+}
+
 // A function to load a texture from a    SDL surface
 SDL_Texture *load_texture(SDL_Surface *surface)
 {
@@ -134,19 +452,19 @@ SDL_Texture *load_texture(SDL_Surface *surface)
         return NULL;
 
     //Convert surface to screen format
-    texture = SDL_CreateTextureFromSurface(renderer, surface);
+    texture = create_texture_from_surface(surface);
     if (texture == NULL)
         log_error("Could not create texture %s", SDL_GetError());
     SDL_FreeSurface(surface);
     return texture;
 }
 
-// A function to rasterize an SVG from an existing text buffer
-SDL_Texture *rasterize_svg(char *buffer, int w, int h, SDL_Rect *rect)
+// A function to rasterize an SVG from an existing text buffer into a surface.
+// The buffer is modified by the parser. Safe to call from any thread
+SDL_Surface *rasterize_svg_surface(char *buffer, int w, int h, SDL_Rect *rect)
 {
     NSVGimage *image = NULL;
-    unsigned char *pixel_buffer = NULL;
-    int width, height, pitch;
+    int width, height;
     float scale;
 
     // Parse SVG to NSVGimage struct
@@ -178,36 +496,33 @@ SDL_Texture *rasterize_svg(char *buffer, int w, int h, SDL_Rect *rect)
         height = h;
     }
     
-    // Allocate memory
-    pitch = 4*width;
-    pixel_buffer = malloc((size_t) (4*width*height));
-    if (pixel_buffer == NULL) {
+    // Rasterize image directly into the surface pixels
+    SDL_Surface *surface = SDL_CreateRGBSurface(0, width, height, 32, COLOR_MASKS);
+    NSVGrasterizer *rasterizer = acquire_rasterizer();
+    if (surface == NULL || rasterizer == NULL) {
         log_error("Could not alloc SVG pixel buffer.");
+        SDL_FreeSurface(surface);
+        nsvgDelete(image);
         return NULL;
     }
-
-    // Rasterize image
-    nsvgRasterize(rasterizer, image, 0, 0, scale, pixel_buffer, width, height, pitch);
-    SDL_Surface *surface = SDL_CreateRGBSurfaceFrom(pixel_buffer,
-                               width,
-                               height,
-                               32,
-                               pitch,
-                               COLOR_MASKS
-                           );
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    nsvgRasterize(rasterizer, image, 0, 0, scale, surface->pixels, width, height, surface->pitch);
+    release_rasterizer(rasterizer);
     if (rect != NULL) {
         rect->w = width;
         rect->h = height;
     }
-    free(pixel_buffer);
-    SDL_FreeSurface(surface);
     nsvgDelete(image);
-    return texture;
+    return surface;
+}
+
+// A function to rasterize an SVG from an existing text buffer
+SDL_Texture *rasterize_svg(char *buffer, int w, int h, SDL_Rect *rect)
+{
+    return load_texture(rasterize_svg_surface(buffer, w, h, rect));
 }
 
-// A function to render the highlight for the buttons
-SDL_Texture *render_highlight(int width, int height, SDL_Rect *rect)
+// A function to render the highlight for the buttons. Safe to call from any thread
+SDL_Surface *render_highlight(int width, int height, SDL_Rect *rect)
 {
     // Insert user config variables into SVG-formatted text buffer
     char *buffer = NULL;
@@ -234,18 +549,18 @@ SDL_Texture *render_highlight(int width, int height, SDL_Rect *rect)
     );
 
     // Rasterize the SVG
-    SDL_Texture *texture = rasterize_svg(buffer, -1, -1, rect);
+    SDL_Surface *surface = rasterize_svg_surface(buffer, -1, -1, rect);
     
     // Cleanup
     free(buffer);
     if (config.highlight_outline_size)
         free(outline_buffer);
 
-    return texture;
+    return surface;
 }
 
-// A function to render the scroll indicators
-void render_scroll_indicators(Scroll *scroll, int height, Geometry *geo)
+// A function to render the right scroll indicator. Safe to call from any thread
+SDL_Surface *render_scroll_indicator(int width, int height, SDL_Rect *rect)
 {
     // Format the SVG
     char *buffer = NULL;
@@ -258,12 +573,16 @@ void render_scroll_indicators(Scroll *scroll, int height, Geometry *geo)
     );
 
     // Rasterize the SVG
-    scroll->texture = rasterize_svg(buffer,
-                          -1,
-                          height,
-                          &scroll->rect_right
-                      );
+    SDL_Surface *surface = rasterize_svg_surface(buffer, width, height, rect);
     free(buffer);
+    return surface;
+}
+
+// A function to create the scroll indicator texture from a rendered surface
+// and position the indicators on the screen
+void load_scroll_indicators(Scroll *scroll, SDL_Surface *surface, Geometry *geo)
+{
+    scroll->texture = load_texture(surface);
     scroll->rect_left.w = scroll->rect_right.w;
     scroll->rect_left.h = scroll->rect_right.h;
     if (scroll->texture == NULL) {
@@ -280,12 +599,14 @@ void render_scroll_indicators(Scroll *scroll, int height, Geometry *geo)
     scroll->rect_left.x = geo->screen_margin;
 }
 
-// A function to render text
+// A function to render text. SDL_ttf is not thread safe, so fonts are
+// locked while rendering for the clock and button worker threads
 SDL_Surface *render_text(const char *text, TextInfo *info, SDL_Rect *rect, int *text_height)
 {
     TTF_Font *output_font = NULL;
     TTF_Font *reduced_font = NULL; // Font for Shrink text oversize mode
     int w, h;
+    SDL_LockMutex(font_mutex);
 
     // Copy text into new buffer in case we need to manipulate it
     char *text_buffer = strdup(text);
@@ -340,18 +661,7 @@ SDL_Surface *render_text(const char *text, TextInfo *info, SDL_Rect *rect, int *
                                   text_buffer, 
                                   *info->shadow_color
                               );
-        surface = SDL_CreateRGBSurfaceWithFormat(0, 
-                      foreground->w + shadow_offset, 
-                      foreground->h + shadow_offset, 
-                      32,
-                      SDL_PIXELFORMAT_ARGB8888
-                  );
-        Uint32 color = SDL_MapRGBA(surface->format, 0, 0, 0, 0);
-        SDL_FillRect(surface, NULL, color);
-        SDL_Rect shadow_rect = {shadow_offset, shadow_offset, shadow->w, shadow->h};
-        SDL_BlitSurface(shadow, NULL, surface, &shadow_rect);
-        SDL_Rect rect = {0, 0, foreground->w, foreground->h};
-        SDL_BlitSurface(foreground, NULL, surface, &rect);
+        surface = compose_text_shadow(foreground, shadow, shadow_offset);
         SDL_FreeSurface(foreground);
         SDL_FreeSurface(shadow);
     }
@@ -371,6 +681,7 @@ SDL_Surface *render_text(const char *text, TextInfo *info, SDL_Rect *rect, int *
     if (reduced_font != NULL)
         TTF_CloseFont(reduced_font);
     free(text_buffer);
+    SDL_UnlockMutex(font_mutex);
     
     return surface;
 }
@@ -3,6 +3,8 @@
 #define HIGHLIGHT_FORMAT "<svg viewBox=\"0 0 %i %i\"><rect x=\"0\" width=\"%i\" height=\"%i\" rx=\"%i\" fill=\"#%02X%02X%02X\" fill-opacity=\"%.2f\"%s/></svg>"
 #define SCROLL_INDICATOR_FORMAT "<svg width=\"195\" height=\"300\" viewBox=\"0 0 195 300\" version=\"1.1\" id=\"SVGRoot\" > <defs id=\"defs889\"/> <g id=\"layer1\" transform=\"translate(-105)\"> <path style=\"fill:#%02X%02X%02X;fill-opacity:%.2f;stroke:#%02X%02X%02X;stroke-width:%i;stroke-linecap:butt;stroke-linejoin:miter;stroke-miterlimit:4;stroke-dasharray:none;stroke-opacity:%.2f\" d=\"M 280,150 150,280 125,255 C 170,210 230.69212,149.36112 230,150 L 125,45 150,20 Z\" id=\"path3884\"/> </g></svg>"
 #define SHADOW_OPACITY_MULTIPLIER 0.75F
+#define EXT_SVG ".svg"
+#define MAX_RASTERIZERS (MAX_WORKER_THREADS + 1) // Every worker and the main thread
 
 // Macro functions
 #define format_highlight_outline(buffer, outline_size, outline_color, outline_opacity) sprintf_alloc(buffer, HIGHLIGHT_OUTLINE_FORMAT, outline_size, outline_color.r, outline_color.g, outline_color.b, outline_opacity)
@@ -21,16 +23,28 @@ typedef struct {
     ModeOversize oversize_mode;
 } TextInfo;
 
+// Linked list of parsed SVG images, so that each file is only parsed once
+typedef struct svg_image {
+    char             *path;
+    struct NSVGimage *image;
+    struct svg_image *next;
+} SVGImage;
+
 int init_svg(void);
 int load_font(TextInfo *info, const char *default_font);
 void quit_svg(void);
-void render_scroll_indicators(Scroll *scroll, int height, Geometry *geo);
-SDL_Surface *load_next_slideshow_background(Slideshow *slideshow, bool transition);
-int load_next_slideshow_background_async(void *data);
+SDL_Surface *load_next_slideshow_background(Slideshow *slideshow, bool *single);
 SDL_Texture *load_texture(SDL_Surface *surface);
 SDL_Texture *load_texture_from_file(const char *path);
+SDL_Surface *load_icon(const char *path);
+SDL_Surface *decode_icon(const char *path, int size);
+SDL_Surface *scale_surface(SDL_Surface *surface, int width, int height);
+SDL_Surface *load_background_image(const char *path, int width, int height);
+SDL_Surface *rasterize_svg_surface(char *buffer, int w, int h, SDL_Rect *rect);
 SDL_Texture *rasterize_svg(char *buffer, int w, int h, SDL_Rect *rect);
 SDL_Texture *rasterize_svg_from_file(const char *path, int w, int h, SDL_Rect *rect);
-SDL_Texture *render_highlight(int width, int height, SDL_Rect *rect);
+SDL_Surface *render_highlight(int width, int height, SDL_Rect *rect);
+SDL_Surface *render_scroll_indicator(int width, int height, SDL_Rect *rect);
+void load_scroll_indicators(Scroll *scroll, SDL_Surface *surface, Geometry *geo);
 SDL_Surface *render_text(const char *text, TextInfo *info, SDL_Rect *rect, int *text_height);
 SDL_Texture *render_text_texture(const char *text, TextInfo *info, SDL_Rect *rect, int *text_height);
@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <SDL.h>
+#include <SDL_thread.h>
+#include "launcher.h"
+#include "jobs.h"
+#include "util.h"
+#include "debug.h"
+
+static Job *take_job(JobQueue *queue);
+static void finish_job(Job *job);
+static int worker_thread(void *data);
+
+static JobQueue pending;
+static SDL_Thread *workers[MAX_WORKER_THREADS];
+static int num_workers = 0;
+
+// A function to initialize a job queue
+int init_job_queue(JobQueue *queue, bool wake)
+{
+    for (int i = 0; i < NUM_JOB_PRIORITIES; i++) {
+        queue->head[i] = NULL;
+        queue->tail[i] = NULL;
+    }
+    queue->wake = wake;
+    queue->mutex = SDL_CreateMutex();
+    queue->count = SDL_CreateSemaphore(0);
+    if (queue->mutex == NULL || queue->count == NULL) {
+        log_error("Could not create job queue\n%s", SDL_GetError());
+        destroy_job_queue(queue);
+        return 1;
+    }
+    return 0;
+}
+
+// A function to destroy a job queue
+void destroy_job_queue(JobQueue *queue)
+{
+    if (queue->mutex != NULL) {
+        SDL_DestroyMutex(queue->mutex);
+        queue->mutex = NULL;
+    }
+    if (queue->count != NULL) {
+        SDL_DestroySemaphore(queue->count);
+        queue->count = NULL;
+    }
+}
+
+// A function to add a job to the back of a queue for its priority
+void push_job(JobQueue *queue, Job *job)
+{
+    JobPriority priority = job->priority;
+    job->next = NULL;
+    SDL_LockMutex(queue->mutex);
+    if (queue->tail[priority] == NULL)
+        queue->head[priority] = job;
+    else
+        queue->tail[priority]->next = job;
+    queue->tail[priority] = job;
+    SDL_UnlockMutex(queue->mutex);
+    SDL_SemPost(queue->count);
+    if (queue->wake)
+        wake_main_loop();
+}
+
+// A function to remove the highest priority job from a queue once the count has been taken
+static Job *take_job(JobQueue *queue)
+{
+    Job *job = NULL;
+    SDL_LockMutex(queue->mutex);
+    for (int i = 0; i < NUM_JOB_PRIORITIES && job == NULL; i++) {
+        job = queue->head[i];
+        if (job != NULL) {
+            queue->head[i] = job->next;
+            if (queue->head[i] == NULL)
+                queue->tail[i] = NULL;
+        }
+    }
+    SDL_UnlockMutex(queue->mutex);
+    return job;
+}
+
+// A function to take a job from the front of a queue, blocking until one is available
+Job *pop_job(JobQueue *queue)
+{
+    SDL_SemWait(queue->count);
+    return take_job(queue);
+}
+
+// A function to take a job from the front of a queue if one is available
+Job *try_pop_job(JobQueue *queue)
+{
+    if (SDL_SemTryWait(queue->count))
+        return NULL;
+    return take_job(queue);
+}
+
+// A function to check whether a queue has jobs waiting
+bool jobs_waiting(JobQueue *queue)
+{
+    return SDL_SemValue(queue->count) > 0;
+}
+
+// A function to prepare a job that is not pushed to any queue when finished
+void init_job(Job *job, void (*function)(Job *job), JobPriority priority)
+{
+    job->function = function;
+    job->complete = NULL;
+    job->completed = NULL;
+    job->finished = NULL;
+    job->priority = priority;
+    job->next = NULL;
+}
+
+// A function to add a finished job to a completion queue without locking.
+// The main loop takes the whole list at once, so a push can't race with a pop
+void push_completion(CompletionQueue *queue, Job *job)
+{
+    void *head;
+    do {
+        head = SDL_AtomicGetPtr(&queue->head);
+        job->next = (Job*) head;
+    } while (!SDL_AtomicCASPtr(&queue->head, head, job));
+    wake_main_loop();
+}
+
+// A function to run the complete function of every finished job on the main
+// thread, in the order the jobs finished
+void run_completions(CompletionQueue *queue)
+{
+    // Take the whole list, then reverse it since it was pushed newest first
+    Job *job = (Job*) SDL_AtomicSetPtr(&queue->head, NULL);
+    Job *ordered = NULL;
+    while (job != NULL) {
+        Job *next = job->next;
+        job->next = ordered;
+        ordered = job;
+        job = next;
+    }
+
+    // The complete function may free or resubmit the job
+    while (ordered != NULL) {
+        Job *next = ordered->next;
+        ordered->complete(ordered);
+        ordered = next;
+    }
+}
+
+// A function to check whether a completion queue has finished jobs waiting
+bool completions_waiting(CompletionQueue *queue)
+{
+    return SDL_AtomicGetPtr(&queue->head) != NULL;
+}
+
+// A function to hand a finished job to the queue that is waiting for it
+static void finish_job(Job *job)
+{
+    if (job->completed != NULL)
+        push_job(job->completed, job);
+    else if (job->finished != NULL)
+        push_completion(job->finished, job);
+}
+
+// A function to run jobs until a job with no function is received
+static int worker_thread(void *data)
+{
+    UNUSED(data);
+    Job *job;
+    while ((job = pop_job(&pending))->function != NULL) {
+        job->function(job);
+        finish_job(job);
+    }
+    return 0;
+}
+
+// A function to start the worker threads, leaving one core for the main thread
+void init_job_pool()
+{
+    if (init_job_queue(&pending, false))
+        return;
+    int count = SDL_GetCPUCount() - 1;
+    if (count < 1)
+        count = 1;
+    else if (count > MAX_WORKER_THREADS)
+        count = MAX_WORKER_THREADS;
+    for (num_workers = 0; num_workers < count; num_workers++) {
+        workers[num_workers] = SDL_CreateThread(worker_thread, "Worker", NULL);
+        if (workers[num_workers] == NULL) {
+            log_error("Could not create worker thread\n%s", SDL_GetError());
+            break;
+        }
+    }
+    log_debug("Started %i worker threads", num_workers);
+}
+
+// A function to run a job on the worker pool, or on the calling
+// thread if no workers are available
+void submit_job(Job *job)
+{
+    if (num_workers == 0) {
+        job->function(job);
+        finish_job(job);
+    }
+    else
+        push_job(&pending, job);
+}
+
+// A function to stop the worker threads once they finish their current jobs
+void quit_job_pool()
+{
+    static Job stop[MAX_WORKER_THREADS];
+    for (int i = 0; i < num_workers; i++) {
+        init_job(&stop[i], NULL, JOB_PRIORITY_LOW);
+        push_job(&pending, &stop[i]);
+    }
+    for (int i = 0; i < num_workers; i++)
+        SDL_WaitThread(workers[i], NULL);
+    num_workers = 0;
+    destroy_job_queue(&pending);
+}
@@ -0,0 +1,48 @@
+#define MAX_WORKER_THREADS 8
+
+// Workers always take high priority jobs before low priority ones
+typedef enum {
+    JOB_PRIORITY_HIGH,
+    JOB_PRIORITY_LOW,
+    NUM_JOB_PRIORITIES
+} JobPriority;
+
+// A unit of work to run on a worker thread. Jobs are embedded as the first
+// member of a larger struct which holds the job's input and output
+typedef struct job {
+    void (*function)(struct job *job);
+    void (*complete)(struct job *job); // Applies the output on the main thread
+    struct job_queue *completed; // Queue the job is pushed to when finished
+    struct completion_queue *finished; // Lock-free queue the job is pushed to when finished
+    JobPriority priority;
+    struct job *next;
+} Job;
+
+// Thread safe FIFO queue of jobs
+typedef struct job_queue {
+    SDL_mutex *mutex;
+    SDL_sem *count;
+    Job *head[NUM_JOB_PRIORITIES];
+    Job *tail[NUM_JOB_PRIORITIES];
+    bool wake; // Wake the main loop when a job is pushed
+} JobQueue;
+
+// Lock-free queue of finished jobs. Any thread can push a job, and the main
+// loop drains the queue, running the complete function of each job
+typedef struct completion_queue {
+    void *head; // Most recently finished job
+} CompletionQueue;
+
+int init_job_queue(JobQueue *queue, bool wake);
+void destroy_job_queue(JobQueue *queue);
+void push_job(JobQueue *queue, Job *job);
+Job *pop_job(JobQueue *queue);
+Job *try_pop_job(JobQueue *queue);
+bool jobs_waiting(JobQueue *queue);
+void init_job(Job *job, void (*function)(Job *job), JobPriority priority);
+void push_completion(CompletionQueue *queue, Job *job);
+void run_completions(CompletionQueue *queue);
+bool completions_waiting(CompletionQueue *queue);
+void init_job_pool(void);
+void submit_job(Job *job);
+void quit_job_pool(void);
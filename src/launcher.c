@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <time.h>
+#include <inttypes.h>
 #include <SDL.h>
 #include <SDL_syswm.h>
 #include <SDL_image.h>
@@ -14,8 +15,62 @@
 #include "util.h"
 #include "debug.h"
 #include "clock.h"
+#include "atlas.h"
+#include "stats.h"
+#include "benchmark.h"
+#include "timeline.h"
+#include "cache.h"
+#include "jobs.h"
+#include "texture.h"
+#include "pixels.h"
+#include "pack.h"
 #include "platform/platform.h"
 
+// Part of a button that is decoded on a worker thread
+typedef enum {
+    BUTTON_ICON,
+    BUTTON_ICON_SELECTED,
+    BUTTON_TITLE
+} ButtonPart;
+
+// Job to decode one part of a button into a surface
+typedef struct button_job {
+    Job job;
+    Menu *menu;
+    unsigned int page;
+    Entry *entry;
+    ButtonPart part;
+    SDL_Surface *surface;
+    int text_height;
+    SharedTexture *shared; // Shared texture loaded by this job, if an icon
+    struct button_job *waiting; // Icon jobs of other entries waiting for the shared texture
+} ButtonJob;
+
+// Job to rasterize an SVG interface element into a surface
+typedef struct {
+    Job job;
+    SDL_Surface *(*render)(int width, int height, SDL_Rect *rect);
+    PackAssetType asset;
+    int width;
+    int height;
+    SDL_Rect *rect;
+    SDL_Surface *surface;
+} SVGJob;
+
+// Job to decode the next slideshow image
+typedef struct {
+    Job job;
+    SDL_Surface *surface;
+    Uint64 decode_time;
+    bool single; // Every other image failed to load
+} SlideshowJob;
+
+// Job to render the clock text, working on a copy of the clock
+typedef struct {
+    Job job;
+    Clock clock;
+} ClockJob;
+
 static void init_sdl(void);
 static void init_sdl_image(void);
 static void create_window(void);
@@ -25,16 +80,57 @@ static int load_menu_by_name(const char *menu_name, bool set_back_menu, bool res
 static void update_slideshow(void);
 static void resume_slideshow(void);
 static void update_screensaver(void);
+static void render_clock_job(Job *job);
+static void complete_clock_job(Job *job);
 static void update_clock(bool block);
+static void set_deadline(int *timeout, Uint32 now, Uint32 deadline);
+static int calculate_wait_timeout(void);
+static void wait_for_event(void);
+static bool idle_frame_due(void);
 static void init_slideshow(void);
+static void decode_slideshow_image(Job *job);
+static void complete_slideshow_job(Job *job);
+static void submit_slideshow_job(void);
+static bool take_slideshow_image(SlideshowImage *image, int *depth);
+static void end_slideshow(SDL_Surface *surface);
 static void init_screensaver(void);
 static void calculate_button_geometry(Entry *entry, int buttons);
+static void rasterize_svg_job(Job *job);
+static void submit_svg_job(SVGJob *job, JobQueue *completed, SDL_Surface *(*render)(int, int, SDL_Rect*), PackAssetType asset, int width, int height, SDL_Rect *rect);
+static void get_highlight_size(int *width, int *height);
+static int get_scroll_indicator_height(void);
+static void compile_theme_pack(Uint64 config_hash);
+static void decode_button(Job *job);
+static void init_button_job(ButtonJob *job, Menu *menu, unsigned int page, Entry *entry, ButtonPart part, JobPriority priority);
+static void submit_icon_job(ButtonJob *job, Menu *menu, unsigned int page, Entry *entry, ButtonPart part, JobPriority priority);
+static void set_button_texture(Entry *entry, ButtonPart part, SDL_Texture *texture, const SDL_Rect *clip, int text_height);
+static void finish_button_job(ButtonJob *job, SDL_Texture *texture, const SDL_Rect *clip);
+static void finish_page(Menu *menu, unsigned int page);
+static void complete_button_job(ButtonJob *job);
+static void submit_page(Menu *menu, unsigned int page, JobPriority priority);
+static unsigned int get_page_distance(Menu *menu, unsigned int page, unsigned int current_page);
+static bool page_missing(Menu *menu, unsigned int page, unsigned int current_page);
+static void init_menu_pages(Menu *menu);
 static void render_buttons(Menu *menu);
+static void prefetch_submenus(Menu *menu);
+static bool has_resident_pages(Menu *menu);
+static void enforce_texture_budget(void);
+static void reset_render_targets(void);
+static void update_prefetch(void);
 static void move_left(void);
 static void move_right(void);
 static void load_submenu(const char *submenu);
 static void load_back_menu(Menu *menu);
+static void mark_button_dirty(Entry *entry);
+static void invalidate_background_layer(void);
+static void draw_background_layers(const SDL_Rect *rect);
+static void render_background_layer(void);
+static void draw_region(const SDL_Rect *rect);
 static void draw_screen(void);
+static void init_frame_pacer(int frame_rate);
+static void pace_frame(void);
+static void run_benchmark_step(void);
+static SDL_Surface *capture_frame(void);
 static void handle_keypress(SDL_Keysym *key);
 static void execute_command(const char *command);
 static void poll_gamepad(void);
@@ -52,7 +148,13 @@ Config config = {
     .title_font_path                  = NULL,
     .vsync                            = true,
     .fps_limit                        = -1,
+    .precise_frame_pacing             = DEFAULT_PRECISE_FRAME_PACING,
     .application_timeout              = DEFAULT_APPLICATION_TIMEOUT * 1000,
+    .low_power_mode                   = DEFAULT_LOW_POWER_MODE,
+    .icon_cache                       = DEFAULT_ICON_CACHE,
+    .texture_budget                   = DEFAULT_TEXTURE_BUDGET,
+    .idle_fps                         = DEFAULT_IDLE_FPS,
+    .frame_stats                      = DEFAULT_FRAME_STATS,
     .titles_enabled                   = DEFAULT_TITLES_ENABLED,
     .title_font_size                  = DEFAULT_FONT_SIZE,
     .title_font_color.r               = DEFAULT_TITLE_FONT_COLOR_R,
@@ -118,6 +220,8 @@ Config config = {
     .mouse_select                     = DEFAULT_MOUSE_SELECT,
     .inhibit_os_screensaver           = DEFAULT_INHIBIT_OS_SCREENSAVER,
     .startup_cmd                      = NULL,
+    .theme_pack                       = NULL,
+    .compile_pack                     = NULL,
     .quit_cmd                         = NULL,
     .screensaver_enabled              = false,
     .screensaver_idle_time            = DEFAULT_SCREENSAVER_IDLE_TIME*1000,
@@ -163,6 +267,8 @@ SDL_Window *window                    = NULL;
 SDL_Renderer *renderer                = NULL;
 SDL_Texture *background_texture       = NULL;
 SDL_Texture *background_overlay       = NULL;
+SDL_Texture *frame_texture            = NULL;
+SDL_Texture *background_layer         = NULL;
 Menu *default_menu                    = NULL;
 Menu *current_menu                    = NULL;
 Entry *current_entry                  = NULL;
@@ -176,17 +282,21 @@ GamepadControl *gamepad_controls      = NULL;
 Hotkey *hotkeys                       = NULL;
 Clock *clk                            = NULL;
 TTF_Font *clock_font                  = NULL;
-SDL_Thread *Slideshowhread            = NULL;
-SDL_Thread *clock_thread              = NULL;
+SDL_mutex *font_mutex                 = NULL;
+JobQueue button_queue;
+CompletionQueue completions           = { NULL };
+SlideshowJob slideshow_job;
+ClockJob clock_job;
+Uint64 menus_shown = 0;
 SDL_Event event;
 SDL_SysWMinfo wm_info;
 SDL_DisplayMode display_mode;
 TextInfo title_info;
 Ticks ticks;
 Geometry geo;
+DirtyRegion dirty_region;
+FramePacer pacer;
 Uint32 refresh_period;
-Uint32 delay_period;
-Uint32 repeat_period;
 
 
 // A function to initialize SDL
@@ -199,6 +309,10 @@ static void init_sdl()
 #endif
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
     SDL_SetHint(SDL_HINT_VIDEO_ALLOW_SCREENSAVER, config.inhibit_os_screensaver ? "0" : "1");
+    if (config.benchmark) {
+        SDL_setenv("SDL_VIDEODRIVER", BENCHMARK_VIDEO_DRIVER, 0);
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, BENCHMARK_RENDER_DRIVER);
+    }
     if (config.gamepad_enabled)
         sdl_flags |= SDL_INIT_GAMECONTROLLER;
 
@@ -207,6 +321,13 @@ static void init_sdl()
         log_fatal("Could not initialize SDL\n%s", SDL_GetError());
 
     SDL_GetDesktopDisplayMode(0, &display_mode);
+
+    // Use a fixed virtual display in benchmark mode so results are comparable between machines
+    if (config.benchmark) {
+        display_mode.w = BENCHMARK_WIDTH;
+        display_mode.h = BENCHMARK_HEIGHT;
+        display_mode.refresh_rate = BENCHMARK_REFRESH_RATE;
+    }
     geo.screen_width = display_mode.w;
     geo.screen_height = display_mode.h;
     refresh_period = 1000 / (Uint32) display_mode.refresh_rate;
@@ -219,9 +340,9 @@ static void create_window()
     window = SDL_CreateWindow(PROJECT_NAME,
                  SDL_WINDOWPOS_UNDEFINED,
                  SDL_WINDOWPOS_UNDEFINED,
-                 0,
-                 0,
-                 SDL_WINDOW_FULLSCREEN_DESKTOP
+                 config.benchmark ? geo.screen_width : 0,
+                 config.benchmark ? geo.screen_height : 0,
+                 config.benchmark ? 0 : SDL_WINDOW_FULLSCREEN_DESKTOP
              );
     if (window == NULL)
         log_fatal("Could not create SDL Window\n%s", SDL_GetError());
@@ -229,25 +350,24 @@ static void create_window()
 
     // Create HW accelerated renderer, get screen resolution for geometry calculations
     Uint32 renderer_flags = SDL_RENDERER_ACCELERATED;
-    if (!config.vsync) {
-        if (config.fps_limit > MIN_FPS_LIMIT && config.fps_limit <= display_mode.refresh_rate)
-            refresh_period = 1000 / (Uint32) config.fps_limit;
-        else
-            config.vsync = true;
-    }
-    if (config.vsync) {
+    if (config.benchmark) {
         refresh_period = 1000 / (Uint32) display_mode.refresh_rate;
-        renderer_flags |= SDL_RENDERER_PRESENTVSYNC;
+        renderer_flags = SDL_RENDERER_SOFTWARE;
     }
-    if (config.gamepad_enabled) {
-        delay_period = GAMEPAD_REPEAT_DELAY / refresh_period;
-        repeat_period = GAMEPAD_REPEAT_INTERVAL / refresh_period;
-        if (!repeat_period)
-            repeat_period = 1;
+    else {
+        if (!config.vsync) {
+            if (config.fps_limit > MIN_FPS_LIMIT && config.fps_limit <= display_mode.refresh_rate) {
+                refresh_period = 1000 / (Uint32) config.fps_limit;
+                init_frame_pacer(config.fps_limit);
+            }
+            else
+                config.vsync = true;
+        }
+        if (config.vsync) {
+            refresh_period = 1000 / (Uint32) display_mode.refresh_rate;
+            renderer_flags |= SDL_RENDERER_PRESENTVSYNC;
+        }
     }
-    if (slideshow != NULL)
-        slideshow->transition_change_rate = 255.0f / ((float) config.slideshow_transition_time / (float) refresh_period);
-
     renderer = SDL_CreateRenderer(window, -1, renderer_flags);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     if (renderer == NULL)
@@ -256,6 +376,30 @@ static void create_window()
     // Set background color
     set_draw_color();
 
+    // Create a persistent frame so that only the changed regions of the screen need to be redrawn
+    if (SDL_RenderTargetSupported(renderer)) {
+        frame_texture = create_texture(SDL_PIXELFORMAT_ARGB8888,
+                            SDL_TEXTUREACCESS_TARGET,
+                            geo.screen_width,
+                            geo.screen_height
+                        );
+        if (frame_texture == NULL)
+            log_error("Could not create frame texture, redrawing the full screen every frame\n%s", SDL_GetError());
+        else
+            SDL_SetTextureBlendMode(frame_texture, SDL_BLENDMODE_NONE);
+
+        // Create a texture to hold the composited background, overlay and scroll indicators
+        background_layer = create_texture(SDL_PIXELFORMAT_ARGB8888,
+                               SDL_TEXTUREACCESS_TARGET,
+                               geo.screen_width,
+                               geo.screen_height
+                           );
+        if (background_layer == NULL)
+            log_error("Could not create background layer texture\n%s", SDL_GetError());
+        else
+            SDL_SetTextureBlendMode(background_layer, SDL_BLENDMODE_NONE);
+    }
+
 #ifdef _WIN32
     SDL_VERSION(&wm_info.version);
     SDL_GetWindowWMInfo(window, &wm_info);
@@ -297,6 +441,9 @@ static void init_sdl_ttf()
 {
     if (TTF_Init() == -1)
         log_fatal("Could not initialize SDL_ttf\n%s", TTF_GetError());
+    font_mutex = SDL_CreateMutex();
+    if (font_mutex == NULL)
+        log_fatal("Could not create font mutex\n%s", SDL_GetError());
     
     title_info = (TextInfo) { 
         .font_size = (int) config.title_font_size,
@@ -322,9 +469,23 @@ static void init_sdl_ttf()
 // A function to close subsystems and free memory before quitting
 static void cleanup()
 {
-    // Wait until all threads have completed
-    SDL_WaitThread(Slideshowhread, NULL);
-    SDL_WaitThread(clock_thread, NULL);
+    // Wait until all threads have completed, then free the output of
+    // jobs that finished after the last time the main loop ran
+    quit_job_pool();
+    ButtonJob *job;
+    while ((job = (ButtonJob*) try_pop_job(&button_queue)) != NULL)
+        SDL_FreeSurface(job->surface);
+    destroy_job_queue(&button_queue);
+    if (slideshow != NULL && slideshow->decoding)
+        SDL_FreeSurface(slideshow_job.surface);
+    if (state.clock_rendering) {
+        SDL_FreeSurface(clock_job.clock.time_surface);
+        SDL_FreeSurface(clock_job.clock.date_surface);
+    }
+
+    // The slideshow owns a texture, so it must be freed while the renderer still exists
+    if (slideshow != NULL)
+        quit_slideshow();
     
     // Destroy renderer and window
     if (renderer != NULL) {
@@ -340,13 +501,11 @@ static void cleanup()
     SDL_Quit();
     IMG_Quit();
     TTF_Quit();
+    SDL_DestroyMutex(font_mutex);
     quit_svg();
-    if (config.background_mode == BACKGROUND_SLIDESHOW)
-        quit_slideshow();
-
-    // Close log file if open
-    if (log_file != NULL)
-        fclose(log_file);
+    close_pack();
+    if (config.benchmark)
+        quit_benchmark();
 
     // Free dynamically allocated memory
     free(config.default_menu);
@@ -358,6 +517,10 @@ static void cleanup()
     free(config.gamepad_mappings_file);
     free(config.startup_cmd);
     free(config.quit_cmd);
+    free(config.benchmark_screenshot);
+    free(config.benchmark_reference);
+    free(config.theme_pack);
+    free(config.compile_pack);
     free(highlight);
     free(scroll);
     free(screensaver);
@@ -370,6 +533,11 @@ static void cleanup()
     Menu *tmp_menu = NULL;
     for (size_t i = 0; i < config.num_menus; i++) {
         free(menu->name);
+        for (unsigned int j = 0; j < menu->num_pages; j++) {
+            free(menu->pages[j].atlases);
+            free(menu->pages[j].jobs);
+        }
+        free(menu->pages);
         entry = menu->first_entry;
         for(size_t j = 0; j < menu->num_entries; j++) {
             free(entry->title);
@@ -384,6 +552,7 @@ static void cleanup()
         menu = menu->next;
         free(tmp_menu);
     }
+    free_shared_textures();
 
     // Free hotkey linked list
     Hotkey *tmp_hotkey = NULL;
@@ -405,6 +574,9 @@ static void cleanup()
 
     if (config.gamepad_enabled)
         disconnect_gamepad(-1, false, true);
+
+    // Close log file if open, after anything that can still write to it
+    quit_log();
 }
 
 // A function to handle key presses from keyboard
@@ -447,12 +619,19 @@ static void handle_keypress(SDL_Keysym *key)
 // A function to quit the slideshow mode in case of error or program exit
 void quit_slideshow()
 {
+    // Free decoded images
+    for (int i = 0; i < slideshow->ring_count; i++)
+        SDL_FreeSurface(slideshow->ring[(slideshow->ring_head + i) % SLIDESHOW_PREFETCH_DEPTH].surface);
+    SDL_FreeSurface(slideshow->final_surface);
+    destroy_texture(slideshow->transition_texture);
+
     // Free allocated image paths
     for (int i = 0; i < slideshow->num_images; i++)
         free(slideshow->images[i]);
     free(slideshow->images);
     free(slideshow->order);
     free(slideshow);
+    slideshow = NULL;
 }
 
 // A function to initialize the slideshow background mode
@@ -472,12 +651,18 @@ static void init_slideshow()
     *slideshow = (Slideshow) {
         .i = -1,
         .num_images = 0,
-        .transition_surface = NULL,
         .transition_texture = NULL,
-        .transition_alpha = 0.f,
-        .transition_change_rate = 0.f,
+        .background_rect = {0, 0, 0, 0},
+        .transition_rect = {0, 0, 0, 0},
+        .transition = {0, 0},
         .images = NULL,
-        .order = NULL
+        .order = NULL,
+        .ring_head = 0,
+        .ring_count = 0,
+        .decoding = false,
+        .waiting = false,
+        .ended = false,
+        .final_surface = NULL
     };
 
     // Find background images from directory
@@ -512,6 +697,90 @@ static void init_slideshow()
     }
 }
 
+// A function to decode the next slideshow image on a worker thread
+static void decode_slideshow_image(Job *job)
+{
+    SlideshowJob *decode = (SlideshowJob*) job;
+    Uint64 start = SDL_GetPerformanceCounter();
+    decode->surface = load_next_slideshow_background(slideshow, &decode->single);
+    decode->decode_time = SDL_GetPerformanceCounter() - start;
+}
+
+// A function to add a decoded slideshow image to the prefetch ring on the main thread
+static void complete_slideshow_job(Job *job)
+{
+    SlideshowJob *decode = (SlideshowJob*) job;
+    slideshow->decoding = false;
+
+    // Stop decoding if fewer than two images could be loaded. The background mode
+    // is changed once the images in the ring and any transition have been shown
+    if (decode->surface == NULL || decode->single) {
+        slideshow->ended = true;
+        slideshow->final_surface = decode->surface;
+        return;
+    }
+    int slot = (slideshow->ring_head + slideshow->ring_count) % SLIDESHOW_PREFETCH_DEPTH;
+    slideshow->ring[slot] = (SlideshowImage) {decode->surface, decode->decode_time};
+    slideshow->ring_count++;
+    submit_slideshow_job();
+}
+
+// A function to start decoding the next slideshow image if the prefetch ring
+// has a free slot. Images are decoded one at a time, in order
+static void submit_slideshow_job()
+{
+    if (slideshow->decoding || slideshow->ended || slideshow->ring_count == SLIDESHOW_PREFETCH_DEPTH)
+        return;
+    init_job(&slideshow_job.job, decode_slideshow_image, JOB_PRIORITY_LOW);
+    slideshow_job.job.complete = complete_slideshow_job;
+    slideshow_job.job.finished = &completions;
+    slideshow_job.surface = NULL;
+    slideshow->decoding = true;
+    submit_job(&slideshow_job.job);
+}
+
+// A function to take the next decoded image from the prefetch ring, if one is ready
+static bool take_slideshow_image(SlideshowImage *image, int *depth)
+{
+    *depth = slideshow->ring_count;
+    if (slideshow->ring_count == 0)
+        return false;
+    *image = slideshow->ring[slideshow->ring_head];
+    slideshow->ring_head = (slideshow->ring_head + 1) % SLIDESHOW_PREFETCH_DEPTH;
+    slideshow->ring_count--;
+    submit_slideshow_job();
+    return true;
+}
+
+// A function to leave slideshow mode when fewer than two of its images could be loaded
+static void end_slideshow(SDL_Surface *surface)
+{
+    // Switch to color background mode if we failed to load any image
+    if (surface == NULL) {
+        log_error(
+            "Could not load any image from slideshow directory %s\n"
+            "Changing background to color mode", 
+            config.slideshow_directory
+        );
+        config.background_mode = BACKGROUND_COLOR;
+        set_draw_color();
+    }
+
+    // If only one image was valid, switch to single image background mode
+    else {
+        log_error(
+            "Could only load one image from slideshow directory %s\n"
+            "Changing background to single image mode",
+            config.slideshow_directory
+        );
+        destroy_texture(background_texture);
+        background_texture = load_texture(surface);
+        config.background_mode = BACKGROUND_IMAGE;
+    }
+    quit_slideshow();
+    invalidate_background_layer();
+}
+
 // A function to initialize the screensaver feature
 static void init_screensaver()
 {
@@ -540,8 +809,7 @@ static void init_screensaver()
     else if (screensaver->alpha_end_value >= 255.0f)
         screensaver->alpha_end_value = 255.0f;
 
-    screensaver->transition_change_rate = screensaver->alpha_end_value / ((float) SCREENSAVER_TRANSITION_TIME / (float) refresh_period);
-    
+
     // Render texture
     SDL_Surface *surface = NULL;
     surface = SDL_CreateRGBSurfaceWithFormat(0, 
@@ -553,7 +821,7 @@ static void init_screensaver()
     Uint32 color = SDL_MapRGBA(surface->format, 0, 0, 0, 0xFF);
     SDL_FillRect(surface, NULL, color);
     screensaver->texture = load_texture(surface);
-    screensaver->alpha = 0.0f;
+    screensaver->transition = (Animation) {0, 0};
     SDL_SetTextureAlphaMod(screensaver->texture, 0.0f);
 }
 
@@ -582,10 +850,6 @@ static int load_menu(Menu *menu, bool set_back_menu, bool reset_position)
         return 1;
     }
 
-    // Render the menu if not already rendered
-    if (current_menu->rendered == false)
-        render_buttons(current_menu);
-
     // Set menu properties
     if (set_back_menu)
         current_menu->back = previous_menu;
@@ -599,6 +863,11 @@ static int load_menu(Menu *menu, bool set_back_menu, bool reset_position)
     else
         current_entry = current_menu->last_selected_entry;
 
+    // Render the pages around the current page if not already rendered
+    current_menu->last_shown = ++menus_shown;
+    render_buttons(current_menu);
+    enforce_texture_budget();
+
     buttons = current_menu->num_entries - (current_menu->page)*config.max_buttons;
     if (buttons > config.max_buttons)
         buttons = config.max_buttons;
@@ -609,6 +878,8 @@ static int load_menu(Menu *menu, bool set_back_menu, bool reset_position)
         highlight->rect.x = current_entry->icon_rect.x - config.highlight_hpadding;
         highlight->rect.y = current_entry->icon_rect.y - config.highlight_vpadding;
     }
+    invalidate_background_layer();
+    prefetch_submenus(current_menu);
     return 0;
 }
 
@@ -642,21 +913,395 @@ static void calculate_button_geometry(Entry *entry, int buttons)
     }
 }
 
-// A function to render all buttons (icon and text) for a menu
-static void render_buttons(Menu *menu)
+// A function to rasterize an SVG interface element on a worker thread
+static void rasterize_svg_job(Job *job)
 {
-    Entry *entry;
-    int h;
-    for (entry = menu->first_entry; entry != NULL; entry = entry->next) {
-        entry->icon = load_texture_from_file(entry->icon_path);
-        entry->icon_selected = (entry->icon_selected_path != NULL) ? load_texture_from_file(entry->icon_selected_path) : NULL;
+    SVGJob *svg = (SVGJob*) job;
+    svg->surface = load_pack_asset(svg->asset, NULL, NULL);
+    if (svg->surface != NULL) {
+        svg->rect->w = svg->surface->w;
+        svg->rect->h = svg->surface->h;
+    }
+    else
+        svg->surface = svg->render(svg->width, svg->height, svg->rect);
+}
+
+// A function to submit an SVG interface element to be rasterized on a worker thread
+static void submit_svg_job(SVGJob *job, JobQueue *completed, SDL_Surface *(*render)(int, int, SDL_Rect*), PackAssetType asset, int width, int height, SDL_Rect *rect)
+{
+    init_job(&job->job, rasterize_svg_job, JOB_PRIORITY_HIGH);
+    job->job.completed = completed;
+    job->render = render;
+    job->asset = asset;
+    job->width = width;
+    job->height = height;
+    job->rect = rect;
+    job->surface = NULL;
+    submit_job(&job->job);
+}
+
+// A function to get the size of the highlight
+static void get_highlight_size(int *width, int *height)
+{
+    int button_height = config.icon_size + config.title_padding + geo.font_height;
+    *width = config.icon_size + 2*config.highlight_hpadding;
+    *height = button_height + 2*config.highlight_vpadding;
+}
+
+// A function to get the height of the scroll indicators
+static int get_scroll_indicator_height()
+{
+    return (int) ((float) geo.screen_height * SCROLL_INDICATOR_HEIGHT);
+}
+
+// A function to render every icon, title, highlight and scroll indicator the
+// config needs, and write them to a theme pack
+static void compile_theme_pack(Uint64 config_hash)
+{
+    Menu *menu = config.first_menu;
+    for (size_t i = 0; i < config.num_menus; i++, menu = menu->next) {
+        for (Entry *entry = menu->first_entry; entry != NULL; entry = entry->next) {
+            const char *icon_paths[] = {entry->icon_path, entry->icon_selected_path};
+            for (size_t j = 0; j < sizeof(icon_paths) / sizeof(icon_paths[0]); j++) {
+                if (icon_paths[j] != NULL && !has_pack_asset(PACK_ASSET_ICON, icon_paths[j]))
+                    add_pack_asset(PACK_ASSET_ICON, icon_paths[j], decode_icon(icon_paths[j], config.icon_size), 0);
+            }
+            if (config.titles_enabled && entry->title != NULL && !has_pack_asset(PACK_ASSET_TITLE, entry->title)) {
+                SDL_Rect rect;
+                int text_height = geo.font_height;
+                SDL_Surface *surface = render_text(entry->title, &title_info, &rect, &text_height);
+                add_pack_asset(PACK_ASSET_TITLE, entry->title, surface, text_height);
+            }
+        }
+    }
+    if (config.highlight) {
+        int width, height;
+        SDL_Rect rect;
+        get_highlight_size(&width, &height);
+        add_pack_asset(PACK_ASSET_HIGHLIGHT, NULL, render_highlight(width, height, &rect), 0);
+    }
+    if (config.scroll_indicators) {
+        SDL_Rect rect;
+        add_pack_asset(PACK_ASSET_SCROLL_INDICATOR,
+            NULL,
+            render_scroll_indicator(-1, get_scroll_indicator_height(), &rect),
+            0
+        );
+    }
+    if (write_pack(config.compile_pack, config_hash))
+        quit(EXIT_FAILURE);
+    printf("Wrote theme pack %s\n", config.compile_pack);
+}
+
+// A function to decode an icon or render a title into a surface on a worker thread
+static void decode_button(Job *job)
+{
+    ButtonJob *button = (ButtonJob*) job;
+    Entry *entry = button->entry;
+    switch (button->part) {
+        case BUTTON_ICON:
+            button->surface = load_icon(entry->icon_path);
+            break;
+
+        case BUTTON_ICON_SELECTED:
+            button->surface = load_icon(entry->icon_selected_path);
+            break;
+
+        case BUTTON_TITLE:
+            button->surface = load_pack_asset(PACK_ASSET_TITLE, entry->title, &button->text_height);
+            if (button->surface != NULL) {
+                entry->text_rect.w = button->surface->w;
+                entry->text_rect.h = button->surface->h;
+            }
+            else
+                button->surface = render_text(entry->title, &title_info, &entry->text_rect, &button->text_height);
+            break;
+    }
+}
+
+// A function to prepare a job for one part of a button
+static void init_button_job(ButtonJob *job, Menu *menu, unsigned int page, Entry *entry, ButtonPart part, JobPriority priority)
+{
+    init_job(&job->job, decode_button, priority);
+    job->job.completed = &button_queue;
+    job->menu = menu;
+    job->page = page;
+    job->entry = entry;
+    job->part = part;
+    job->surface = NULL;
+    job->text_height = geo.font_height;
+    job->shared = NULL;
+    job->waiting = NULL;
+    menu->pages[page].pending_jobs++;
+}
+
+// A function to queue the loading of an icon, sharing the texture
+// with every other entry that uses the same image file
+static void submit_icon_job(ButtonJob *job, Menu *menu, unsigned int page, Entry *entry, ButtonPart part, JobPriority priority)
+{
+    const char *path = part == BUTTON_ICON ? entry->icon_path : entry->icon_selected_path;
+    SharedTexture **shared = part == BUTTON_ICON ? &entry->icon_shared : &entry->icon_selected_shared;
+    bool created;
+    *shared = acquire_shared_texture(path, &created);
+
+    // The image is already loaded, so no job is needed
+    if (!created && (*shared)->loader == NULL) {
+        set_button_texture(entry, part, (*shared)->texture, &(*shared)->clip, geo.font_height);
+        return;
+    }
+    init_button_job(job, menu, page, entry, part, priority);
+    job->shared = *shared;
+
+    // Another entry is already loading the image, so wait for it to finish
+    if (!created) {
+        ButtonJob *loader = (ButtonJob*) (*shared)->loader;
+        job->waiting = loader->waiting;
+        loader->waiting = job;
+    }
+    else {
+        (*shared)->loader = job;
+        submit_job(&job->job);
+    }
+}
+
+// A function to set the texture of one part of a button. The clip is the
+// area of the texture holding the part, or NULL for the whole texture
+static void set_button_texture(Entry *entry, ButtonPart part, SDL_Texture *texture, const SDL_Rect *clip, int text_height)
+{
+    SDL_Rect rect = {0, 0, 0, 0};
+    if (clip != NULL)
+        rect = *clip;
+    else if (texture != NULL)
+        SDL_QueryTexture(texture, NULL, NULL, &rect.w, &rect.h);
+    switch (part) {
+        case BUTTON_ICON:
+            entry->icon = texture;
+            entry->icon_clip = rect;
+            break;
+
+        case BUTTON_ICON_SELECTED:
+            entry->icon_selected = texture;
+            entry->icon_selected_clip = rect;
+            break;
+
+        case BUTTON_TITLE:
+            entry->title_texture = texture;
+            if (config.title_oversize_mode == OVERSIZE_SHRINK && text_height != geo.font_height)
+                entry->title_offset = (geo.font_height - text_height) / 2;
+            break;
+    }
+}
+
+// A function to set the texture of a button part from a job, and finish
+// the page once all of its buttons are complete
+static void finish_button_job(ButtonJob *job, SDL_Texture *texture, const SDL_Rect *clip)
+{
+    set_button_texture(job->entry, job->part, texture, clip, job->text_height);
+    if (--job->menu->pages[job->page].pending_jobs == 0)
+        finish_page(job->menu, job->page);
+}
+
+// A function to pack a page into atlases once all of its buttons are complete
+static void finish_page(Menu *menu, unsigned int page)
+{
+    MenuPage *menu_page = &menu->pages[page];
+    free(menu_page->jobs);
+    menu_page->jobs = NULL;
+    create_page_atlas(menu, page);
+    menu_page->rendered = true;
+    log_debug("Rendered page %u of menu '%s'", page, menu->name);
+    enforce_texture_budget();
+}
+
+// A function to create the texture for a decoded part of a button on the main thread
+static void complete_button_job(ButtonJob *job)
+{
+    if (job->shared == NULL) {
+        finish_button_job(job, load_texture(job->surface), NULL);
+        return;
+    }
+
+    // Copy the icon into the shared icon atlas, and give it to the entries that were
+    // waiting for it. Finishing a job can free its page's jobs, so the waiting list is read first
+    SDL_Texture *texture = upload_shared_texture(job->shared, job->surface);
+    SDL_Rect clip = job->shared->clip;
+    job->shared->loader = NULL;
+    ButtonJob *waiting = job->waiting;
+    finish_button_job(job, texture, &clip);
+    while (waiting != NULL) {
+        ButtonJob *next = waiting->waiting;
+        finish_button_job(waiting, texture, &clip);
+        waiting = next;
+    }
+}
+
+// A function to queue the decoding of every icon and title on a page of a menu
+static void submit_page(Menu *menu, unsigned int page, JobPriority priority)
+{
+    MenuPage *menu_page = &menu->pages[page];
+    unsigned int num_entries = get_page_entries(menu, page);
+    ButtonJob *jobs = malloc(3 * num_entries * sizeof(ButtonJob));
+    int num_jobs = 0;
+    menu_page->jobs = jobs;
+    menu_page->pending_jobs = 0;
+    Entry *entry = get_page_entry(menu, page);
+    for (unsigned int i = 0; i < num_entries; i++, entry = entry->next) {
+        entry->icon = NULL;
+        entry->icon_selected = NULL;
+        entry->title_texture = NULL;
+        submit_icon_job(&jobs[num_jobs++], menu, page, entry, BUTTON_ICON, priority);
+        if (entry->icon_selected_path != NULL)
+            submit_icon_job(&jobs[num_jobs++], menu, page, entry, BUTTON_ICON_SELECTED, priority);
         if (config.titles_enabled) {
-            entry->title_texture = render_text_texture(entry->title, &title_info, &entry->text_rect, &h);
-            if (config.title_oversize_mode == OVERSIZE_SHRINK && h != geo.font_height)
-                entry->title_offset = (geo.font_height - h) / 2;
+            init_button_job(&jobs[num_jobs], menu, page, entry, BUTTON_TITLE, priority);
+            submit_job(&jobs[num_jobs++].job);
+        }
+    }
+
+    // Every icon was already loaded and there are no titles to render
+    if (menu_page->pending_jobs == 0)
+        finish_page(menu, page);
+}
+
+// A function to get the number of page turns between two pages of a menu
+static unsigned int get_page_distance(Menu *menu, unsigned int page, unsigned int current_page)
+{
+    unsigned int distance = page > current_page ? page - current_page : current_page - page;
+    if (config.wrap_entries)
+        distance = MIN(distance, menu->num_pages - distance);
+    return distance;
+}
+
+// A function to check if a page of a menu needs to be rendered to be resident around a page
+static bool page_missing(Menu *menu, unsigned int page, unsigned int current_page)
+{
+    return !menu->pages[page].rendered && menu->pages[page].pending_jobs == 0 &&
+           get_page_distance(menu, page, current_page) <= PAGE_RESIDENCY_RADIUS;
+}
+
+// A function to allocate the pages of a menu the first time it is used
+static void init_menu_pages(Menu *menu)
+{
+    if (menu->pages != NULL)
+        return;
+    menu->num_pages = DIV_ROUND_UP(menu->num_entries, config.max_buttons);
+    menu->pages = calloc(menu->num_pages, sizeof(MenuPage));
+}
+
+// A function to render the buttons (icon and text) for the pages of a menu near
+// the current page, and release the pages far away from it
+static void render_buttons(Menu *menu)
+{
+    init_menu_pages(menu);
+    for (unsigned int page = 0; page < menu->num_pages; page++) {
+        if (menu->pages[page].rendered && get_page_distance(menu, page, menu->page) >= PAGE_RELEASE_DISTANCE) {
+            free_page_textures(menu, page);
+            log_debug("Released page %u of menu '%s'", page, menu->name);
+        }
+    }
+
+    // Decode the missing pages concurrently on the worker pool, ahead of any prefetching
+    for (unsigned int page = 0; page < menu->num_pages; page++) {
+        if (page_missing(menu, page, menu->page))
+            submit_page(menu, page, JOB_PRIORITY_HIGH);
+    }
+
+    // Create the textures as the surfaces arrive, until every page near the
+    // current page is complete, including pages that were being prefetched
+    for (unsigned int page = 0; page < menu->num_pages; page++) {
+        while (menu->pages[page].pending_jobs > 0 &&
+        get_page_distance(menu, page, menu->page) <= PAGE_RESIDENCY_RADIUS)
+            complete_button_job((ButtonJob*) pop_job(&button_queue));
+    }
+    log_shared_textures();
+}
+
+// A function to prefetch the first pages of the submenus that can be entered
+// from a menu at low priority, so they are ready when the user enters them
+static void prefetch_submenus(Menu *menu)
+{
+    if (over_texture_budget())
+        return;
+    size_t length = strlen(SCMD_SUBMENU);
+    for (Entry *entry = menu->first_entry; entry != NULL; entry = entry->next) {
+        if (entry->cmd == NULL || strncmp(entry->cmd, SCMD_SUBMENU, length) || entry->cmd[length] != ' ')
+            continue;
+        Menu *submenu = get_menu(entry->cmd + length + 1);
+        if (submenu == NULL || submenu == menu || submenu->num_entries == 0)
+            continue;
+        init_menu_pages(submenu);
+        for (unsigned int page = 0; page < submenu->num_pages; page++) {
+            if (page_missing(submenu, page, 0))
+                submit_page(submenu, page, JOB_PRIORITY_LOW);
+        }
+    }
+}
+
+// A function to check if any pages of a menu have textures
+static bool has_resident_pages(Menu *menu)
+{
+    for (unsigned int page = 0; page < menu->num_pages; page++) {
+        if (menu->pages[page].rendered)
+            return true;
+    }
+    return false;
+}
+
+// A function to release the icons and titles of the least recently shown
+// menus until the textures fit in the texture budget
+static void enforce_texture_budget()
+{
+    while (over_texture_budget()) {
+        Menu *oldest = NULL;
+        Menu *menu = config.first_menu;
+        for (size_t i = 0; i < config.num_menus; i++, menu = menu->next) {
+            if (menu != current_menu && has_resident_pages(menu) &&
+            (oldest == NULL || menu->last_shown < oldest->last_shown))
+                oldest = menu;
+        }
+        if (oldest == NULL)
+            return;
+        for (unsigned int page = 0; page < oldest->num_pages; page++) {
+            if (oldest->pages[page].rendered)
+                free_page_textures(oldest, page);
         }
+        log_debug("Released menu '%s' to fit texture budget, %" PRIu64 " KB of textures in use",
+            oldest->name,
+            get_texture_memory() / 1024
+        );
+    }
+}
+
+// A function to restore the contents of the render target textures after the
+// renderer lost them. The page atlases are released and the pages around the
+// current page are rendered again, because the title textures they were packed
+// from no longer exist. The frame and background layer are redrawn in full.
+// A device reset, which loses every texture, is not handled
+static void reset_render_targets()
+{
+    Menu *menu = config.first_menu;
+    for (size_t i = 0; i < config.num_menus; i++, menu = menu->next) {
+        for (unsigned int page = 0; menu->pages != NULL && page < menu->num_pages; page++) {
+            if (menu->pages[page].rendered)
+                free_page_textures(menu, page);
+        }
+    }
+    log_debug("Render targets were reset, rendering menu '%s' again", current_menu->name);
+    render_buttons(current_menu);
+    invalidate_background_layer();
+}
+
+// A function to create the textures of prefetched buttons, a few
+// per frame so that prefetching doesn't delay input
+static void update_prefetch()
+{
+    ButtonJob *job;
+    for (int i = 0; i < PREFETCH_UPLOADS_PER_FRAME; i++) {
+        job = (ButtonJob*) try_pop_job(&button_queue);
+        if (job == NULL)
+            break;
+        complete_button_job(job);
     }
-    menu->rendered = true;
 }
 
 // A function to move the selection left when clicked by user
@@ -664,10 +1309,12 @@ static void move_left()
 {
     // If we are not in leftmost position, move highlight left
     if (current_menu->highlight_position > 0) {
+        mark_button_dirty(current_entry);
         if (config.highlight)
             highlight->rect.x -= geo.x_advance;
         current_menu->highlight_position--;
         current_entry = current_entry->previous;
+        mark_button_dirty(current_entry);
     }
 
     // If we are in leftmost position...
@@ -694,10 +1341,12 @@ static void move_left()
             buttons = current_menu->num_entries - current_menu->page * config.max_buttons;
         }
 
+        render_buttons(current_menu);
         calculate_button_geometry(current_menu->root_entry, (int) buttons);
         if (config.highlight)
             highlight->rect.x = current_entry->icon_rect.x - config.highlight_hpadding;
         current_menu->highlight_position = buttons - 1;
+        invalidate_background_layer();
     }
 }
 
@@ -706,10 +1355,12 @@ static void move_right()
 {
     // If we are not in the rightmost position, move highlight right
     if ((int) current_menu->highlight_position < (geo.num_buttons - 1)) {
+        mark_button_dirty(current_entry);
         if (config.highlight)
             highlight->rect.x += geo.x_advance;
         current_menu->highlight_position++;
         current_entry = current_entry->next;
+        mark_button_dirty(current_entry);
     }
 
     // If we are in the rightmost postion, but there are more entries in the menu, load next page
@@ -720,11 +1371,13 @@ static void move_right()
             buttons = config.max_buttons;
         current_entry = current_entry->next;
         current_menu->root_entry = current_entry;
+        current_menu->page++;
+        render_buttons(current_menu);
         calculate_button_geometry(current_menu->root_entry, (int) buttons);
         if (config.highlight)
             highlight->rect.x = current_entry->icon_rect.x - config.highlight_hpadding;
-        current_menu->page++;
         current_menu->highlight_position = 0;
+        invalidate_background_layer();
     }
 
     // If user has the wrap entries setting, reset menu to first entry
@@ -733,9 +1386,11 @@ static void move_right()
         current_menu->root_entry = current_entry;
         current_menu->highlight_position = 0;
         current_menu->page = 0;
+        render_buttons(current_menu);
         if (config.highlight)
             highlight->rect.x = current_entry->icon_rect.x - config.highlight_hpadding;
         calculate_button_geometry(current_menu->root_entry, (int) MIN(current_menu->num_entries, config.max_buttons));
+        invalidate_background_layer();
     }
 }
 
@@ -752,69 +1407,276 @@ static void load_back_menu(Menu *menu)
     load_menu(menu->back, false, config.reset_on_back);
 }
 
-// A function to update the screen with all visible textures
-static void draw_screen()
+// A function to mark a region of the screen as changed, or the whole screen if NULL
+void mark_dirty(const SDL_Rect *rect)
 {
-    // Draw background
-    SDL_RenderClear(renderer);
-    if (!(state.application_launching && config.on_launch == ON_LAUNCH_BLANK)) {
-        if (config.background_mode == BACKGROUND_IMAGE || config.background_mode == BACKGROUND_SLIDESHOW)
-            SDL_RenderCopy(renderer, background_texture, NULL, NULL);
+    state.redraw = true;
+    if (dirty_region.full_screen)
+        return;
+    if (rect == NULL) {
+        dirty_region.full_screen = true;
+        dirty_region.num_rects = 0;
+        return;
+    }
+    if (rect->w <= 0 || rect->h <= 0)
+        return;
 
-        if (config.background_mode == BACKGROUND_SLIDESHOW && state.slideshow_transition)
-            SDL_RenderCopy(renderer, slideshow->transition_texture, NULL, NULL);
+    // Merge with an overlapping region if possible, otherwise add a new one
+    for (int i = 0; i < dirty_region.num_rects; i++) {
+        if (SDL_HasIntersection(rect, &dirty_region.rects[i])) {
+            SDL_UnionRect(rect, &dirty_region.rects[i], &dirty_region.rects[i]);
+            return;
+        }
+    }
+    if (dirty_region.num_rects == MAX_DIRTY_RECTS)
+        SDL_UnionRect(rect, &dirty_region.rects[MAX_DIRTY_RECTS - 1], &dirty_region.rects[MAX_DIRTY_RECTS - 1]);
+    else
+        dirty_region.rects[dirty_region.num_rects++] = *rect;
+}
 
-        // Draw background overlay
-        if (config.background_overlay)
-            SDL_RenderCopy(renderer, background_overlay, NULL, NULL);
+// A function to mark the screen area covered by a button as changed
+static void mark_button_dirty(Entry *entry)
+{
+    SDL_Rect rect = entry->icon_rect;
+    if (config.titles_enabled)
+        SDL_UnionRect(&rect, &entry->text_rect, &rect);
+    if (config.highlight) {
+        SDL_Rect highlight_rect = {
+            .x = entry->icon_rect.x - config.highlight_hpadding,
+            .y = entry->icon_rect.y - config.highlight_vpadding,
+            .w = highlight->rect.w,
+            .h = highlight->rect.h
+        };
+        SDL_UnionRect(&rect, &highlight_rect, &rect);
+    }
+    mark_dirty(&rect);
+}
 
-        // Draw scroll indicators
-        if (config.scroll_indicators &&
-        (current_menu->page*config.max_buttons + (unsigned int) geo.num_buttons) <= (current_menu->num_entries - 1))
-            SDL_RenderCopy(renderer, scroll->texture, NULL, &scroll->rect_right);
+// A function to flag the background layer for recompositing and redraw the whole screen
+static void invalidate_background_layer()
+{
+    state.background_layer_stale = true;
+    mark_dirty(NULL);
+}
 
-        if (config.scroll_indicators && current_menu->page > 0)
-            SDL_RenderCopyEx(renderer, scroll->texture, NULL, &scroll->rect_left, 0, NULL, SDL_FLIP_HORIZONTAL);
+// A function to draw the static background layers within a region of the screen,
+// or the whole screen if NULL
+static void draw_background_layers(const SDL_Rect *rect)
+{
+    if (rect == NULL)
+        SDL_RenderClear(renderer);
+    else
+        SDL_RenderFillRect(renderer, rect);
+    if (config.background_mode == BACKGROUND_IMAGE)
+        SDL_RenderCopy(renderer, background_texture, NULL, NULL);
+    else if (config.background_mode == BACKGROUND_SLIDESHOW)
+        SDL_RenderCopy(renderer, background_texture, &slideshow->background_rect, NULL);
+
+    if (config.background_mode == BACKGROUND_SLIDESHOW && state.slideshow_transition)
+        SDL_RenderCopy(renderer, slideshow->transition_texture, &slideshow->transition_rect, NULL);
+
+    // Draw background overlay
+    if (config.background_overlay)
+        SDL_RenderCopy(renderer, background_overlay, NULL, NULL);
+
+    // Draw scroll indicators
+    if (config.scroll_indicators &&
+    (current_menu->page*config.max_buttons + (unsigned int) geo.num_buttons) <= (current_menu->num_entries - 1) &&
+    (rect == NULL || SDL_HasIntersection(rect, &scroll->rect_right)))
+        SDL_RenderCopy(renderer, scroll->texture, NULL, &scroll->rect_right);
+
+    if (config.scroll_indicators && current_menu->page > 0 &&
+    (rect == NULL || SDL_HasIntersection(rect, &scroll->rect_left)))
+        SDL_RenderCopyEx(renderer, scroll->texture, NULL, &scroll->rect_left, 0, NULL, SDL_FLIP_HORIZONTAL);
+}
+
+// A function to composite the background, overlay and scroll indicators into a single texture
+static void render_background_layer()
+{
+    SDL_Texture *target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, background_layer);
+    draw_background_layers(NULL);
+    SDL_SetRenderTarget(renderer, target);
+    state.background_layer_stale = false;
+}
+
+// A function to draw all visible textures within a region of the screen,
+// or the whole screen if NULL
+static void draw_region(const SDL_Rect *rect)
+{
+    // Draw background
+    if (state.application_launching && config.on_launch == ON_LAUNCH_BLANK) {
+        if (rect == NULL)
+            SDL_RenderClear(renderer);
+        else
+            SDL_RenderFillRect(renderer, rect);
+    }
+    else {
+        // Use the precomposited background layer unless the slideshow is fading between images
+        if (background_layer != NULL && !state.slideshow_transition)
+            SDL_RenderCopy(renderer, background_layer, rect, rect);
+        else
+            draw_background_layers(rect);
 
         // Draw clock
         if (config.clock_enabled) {
-            SDL_RenderCopy(renderer, clk->time_texture, NULL, &clk->time_rect);
-            if (config.clock_show_date)
-                SDL_RenderCopy(renderer, clk->date_texture, NULL, &clk->date_rect);
+            SDL_Rect time_source = {0, 0, clk->time_rect.w, clk->time_rect.h};
+            SDL_Rect date_source = {0, 0, clk->date_rect.w, clk->date_rect.h};
+            if (rect == NULL || SDL_HasIntersection(rect, &clk->time_rect))
+                SDL_RenderCopy(renderer, clk->time_texture, &time_source, &clk->time_rect);
+            if (config.clock_show_date && (rect == NULL || SDL_HasIntersection(rect, &clk->date_rect)))
+                SDL_RenderCopy(renderer, clk->date_texture, &date_source, &clk->date_rect);
         }
 
         // Draw highlight
-        if (config.highlight)
+        if (config.highlight && (rect == NULL || SDL_HasIntersection(rect, &highlight->rect)))
             SDL_RenderCopy(renderer,
                 highlight->texture,
                 NULL,
                 &highlight->rect
             );
 
-        // Draw buttons
+        // Draw buttons, with all of the titles after the icons so
+        // that the titles from the page atlas are batched together
         Entry *entry = current_menu->root_entry;
-        SDL_Texture *icon;
         for (int i = 0; i < geo.num_buttons; i++) {
-            icon = (entry->icon_selected != NULL && i == (int) current_menu->highlight_position) ? entry->icon_selected : entry->icon;
-            SDL_RenderCopy(renderer, icon, NULL, &entry->icon_rect);
-            if (config.titles_enabled)
-                SDL_RenderCopy(renderer, entry->title_texture, NULL, &entry->text_rect);
-            entry = entry-> next;
+            if (rect == NULL || SDL_HasIntersection(rect, &entry->icon_rect)) {
+                if (entry->icon_selected != NULL && i == (int) current_menu->highlight_position)
+                    batch_copy(entry->icon_selected, &entry->icon_selected_clip, &entry->icon_rect);
+                else
+                    batch_copy(entry->icon, &entry->icon_clip, &entry->icon_rect);
+            }
+            entry = entry->next;
         }
+        entry = current_menu->root_entry;
+        for (int i = 0; i < geo.num_buttons && config.titles_enabled; i++) {
+            if (rect == NULL || SDL_HasIntersection(rect, &entry->text_rect))
+                batch_copy(entry->title_texture, &entry->title_clip, &entry->text_rect);
+            entry = entry->next;
+        }
+        flush_batch();
 
         // Draw screensaver
         if (state.screensaver_active)
             SDL_RenderCopy(renderer, screensaver->texture, NULL, NULL);
     }
-    else
-        SDL_RenderFillRect(renderer, NULL);
+}
+
+// A function to update the screen with all visible textures
+static void draw_screen()
+{
+    start_phase(PHASE_DRAW);
+    // Recomposite the background layer if it has changed
+    if (background_layer != NULL && state.background_layer_stale && !state.slideshow_transition)
+        render_background_layer();
+
+    // Redraw everything directly to the screen if we don't have a frame texture
+    if (frame_texture == NULL)
+        draw_region(NULL);
+
+    // Otherwise, only redraw the changed regions of the frame
+    else {
+        SDL_SetRenderTarget(renderer, frame_texture);
+        if (dirty_region.full_screen)
+            draw_region(NULL);
+        else {
+            for (int i = 0; i < dirty_region.num_rects; i++) {
+                SDL_RenderSetClipRect(renderer, &dirty_region.rects[i]);
+                draw_region(&dirty_region.rects[i]);
+            }
+            SDL_RenderSetClipRect(renderer, NULL);
+        }
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_RenderCopy(renderer, frame_texture, NULL, NULL);
+    }
+    dirty_region.full_screen = false;
+    dirty_region.num_rects = 0;
+    state.redraw = false;
+
+    end_phase(PHASE_DRAW);
 
     // Output to screen
+    start_phase(PHASE_PRESENT);
     SDL_RenderPresent(renderer);
-    if (!config.vsync) {
-        Uint32 sleep_time = refresh_period - (SDL_GetTicks() - ticks.main);
-        if (sleep_time > 0)
-            SDL_Delay(sleep_time);
+    end_phase(PHASE_PRESENT);
+    ticks.last_frame = ticks.main;
+    if (config.benchmark)
+        count_benchmark_frame();
+    else if (!config.vsync)
+        pace_frame();
+}
+
+// A function to copy the last rendered frame into a surface
+static SDL_Surface *capture_frame()
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0,
+                               geo.screen_width,
+                               geo.screen_height,
+                               32,
+                               SDL_PIXELFORMAT_ARGB8888
+                           );
+    if (surface == NULL)
+        return NULL;
+
+    // The screen contents are undefined after presenting, so read from the frame texture,
+    // or redraw the frame if there isn't one
+    if (frame_texture != NULL)
+        SDL_SetRenderTarget(renderer, frame_texture);
+    else
+        draw_region(NULL);
+    if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, surface->pixels, surface->pitch) < 0) {
+        log_error("Could not read frame pixels\n%s", SDL_GetError());
+        SDL_FreeSurface(surface);
+        surface = NULL;
+    }
+    SDL_SetRenderTarget(renderer, NULL);
+    return surface;
+}
+
+// A function to execute the next command of the benchmark script, or finish the benchmark
+static void run_benchmark_step()
+{
+    if (benchmark_finished()) {
+        SDL_Surface *frame = NULL;
+        if (config.benchmark_screenshot != NULL || config.benchmark_reference != NULL)
+            frame = capture_frame();
+        print_benchmark_results(stdout);
+        int status = check_benchmark_results(frame);
+        SDL_FreeSurface(frame);
+        quit(status);
+    }
+    execute_command(next_benchmark_command());
+}
+
+// A function to initialize the frame pacer for a given frame rate
+static void init_frame_pacer(int frame_rate)
+{
+    pacer.frequency = SDL_GetPerformanceFrequency();
+    pacer.period = pacer.frequency / (Uint64) frame_rate;
+    pacer.deadline = SDL_GetPerformanceCounter();
+}
+
+// A function to wait until the deadline of the next frame
+static void pace_frame()
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    pacer.deadline += pacer.period;
+
+    // If the frame overran its deadline, skip the missed frames instead of trying to catch up
+    if (now >= pacer.deadline) {
+        pacer.deadline = now;
+        return;
+    }
+
+    // Sleep for most of the remaining time, then spin until the deadline if precise pacing is enabled
+    Uint32 sleep_time = (Uint32) ((pacer.deadline - now) * 1000 / pacer.frequency);
+    if (config.precise_frame_pacing)
+        sleep_time = sleep_time > FRAME_PACER_SPIN_TIME ? sleep_time - FRAME_PACER_SPIN_TIME : 0;
+    if (sleep_time > 0)
+        SDL_Delay(sleep_time);
+    if (config.precise_frame_pacing) {
+        while (SDL_GetPerformanceCounter() < pacer.deadline)
+            continue;
     }
 }
 
@@ -856,6 +1718,8 @@ static void execute_command(const char *command)
             scmd_restart();
         else if (!strcmp(special_command, SCMD_SLEEP))
             scmd_sleep();
+        else if (!strcmp(special_command, SCMD_STATS))
+            log_stats();
     }
 
     // Launch external application
@@ -863,6 +1727,7 @@ static void execute_command(const char *command)
         SDL_Delay(50);
         if (start_process(cmd, true)) {
             state.application_launching = true;
+            mark_dirty(NULL);
             ticks.application_launched = ticks.main;
             if (config.on_launch == ON_LAUNCH_BLANK)
                 SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
@@ -966,6 +1831,7 @@ static void poll_gamepad()
 {
     int value_multiplier; // Handles positive or negative axis
     bool pressed;
+    Uint64 now = get_timeline_time();
     for (GamepadControl *i = gamepad_controls; i != NULL; i = i->next) {
         pressed = false;
         for (Gamepad *gamepad = gamepads; gamepad != NULL; gamepad = gamepad->next) {
@@ -977,7 +1843,6 @@ static void poll_gamepad()
                 else if (i->type == TYPE_AXIS_NEG)
                     value_multiplier = -1;
                 if (value_multiplier*SDL_GameControllerGetAxis(gamepad->controller, i->index) > GAMEPAD_DEADZONE) {
-                    i->repeat++;
                     pressed = true;
                     break;
                 }
@@ -986,7 +1851,6 @@ static void poll_gamepad()
             // Check buttons
             else if (i->type == TYPE_BUTTON) {
                 if (SDL_GameControllerGetButton(gamepad->controller, i->index)) {
-                    i->repeat++;
                     pressed = true;
                     break;
                 }
@@ -997,16 +1861,21 @@ static void poll_gamepad()
             continue;
         }
 
-        // Execute command if first press or valid repeat
-        if (i->repeat == 1) {
+        // Execute command if first press or the repeat time has been reached
+        if (!i->repeat) {
             log_debug("Gamepad %s detected", i->label);
             ticks.last_input = ticks.main;
+            i->repeat = now + ms_to_counter(GAMEPAD_REPEAT_DELAY);
             execute_command(i->cmd);
         }
-        else if (i->repeat == delay_period) {
+        else if (now >= i->repeat) {
             ticks.last_input = ticks.main;
+
+            // Don't queue up missed repeats after a slow frame
+            i->repeat += ms_to_counter(GAMEPAD_REPEAT_INTERVAL);
+            if (i->repeat <= now)
+                i->repeat = now + ms_to_counter(GAMEPAD_REPEAT_INTERVAL);
             execute_command(i->cmd);
-            i->repeat -= repeat_period;
         }
     }
 }
@@ -1018,47 +1887,59 @@ static void update_slideshow()
     if (!state.slideshow_transition && (ticks.main - ticks.slideshow_load > config.slideshow_image_duration) &&
     !state.slideshow_paused) {
         
-        // Render the new background image in a separate thread so we don't block the main thread
-        if (!state.slideshow_background_rendering && !state.slideshow_background_ready) {
-            Slideshowhread = SDL_CreateThread(load_next_slideshow_background_async, "Slideshow Thread", (void*) slideshow);
-            state.slideshow_background_rendering = true;
-        }
-
-        // Convert background to texture after the rendering thread has completed
-        else if (state.slideshow_background_ready) {
-            SDL_WaitThread(Slideshowhread, NULL);
-            Slideshowhread = NULL;
-            if (config.slideshow_transition_time > 0) {
-                slideshow->transition_texture = load_texture(slideshow->transition_surface);
-                SDL_SetTextureAlphaMod(slideshow->transition_texture, 0);
-                state.slideshow_transition = true;
+        // Take the next image, which has usually been decoded long before it is due
+        SlideshowImage image;
+        int depth;
+        if (!take_slideshow_image(&image, &depth)) {
+            if (slideshow->ended) {
+                SDL_Surface *surface = slideshow->final_surface;
+                slideshow->final_surface = NULL;
+                end_slideshow(surface);
             }
-            else {
-                SDL_DestroyTexture(background_texture);
-                background_texture = load_texture(slideshow->transition_surface);
-                ticks.slideshow_load = ticks.main;
-            }
-        slideshow->transition_surface = NULL;
-        state.slideshow_background_ready = false;
+            else
+                slideshow->waiting = true;
+            return;
+        }
+        Uint32 delay = ticks.main - ticks.slideshow_load - config.slideshow_image_duration;
+        record_slideshow_image(image.decode_time, slideshow->waiting ? 0 : depth, slideshow->waiting ? delay : 0);
+        slideshow->waiting = false;
+
+        // Copy the image into the streaming texture that is not on screen
+        if (config.slideshow_transition_time > 0) {
+            if (slideshow->transition_texture == NULL)
+                slideshow->transition_texture = create_streaming_texture(geo.screen_width, geo.screen_height);
+            update_streaming_texture(slideshow->transition_texture, image.surface, &slideshow->transition_rect);
+            SDL_SetTextureAlphaMod(slideshow->transition_texture, 0);
+            start_animation(&slideshow->transition, config.slideshow_transition_time);
+            state.slideshow_transition = true;
+        }
+        else {
+            update_streaming_texture(background_texture, image.surface, &slideshow->background_rect);
+            ticks.slideshow_load = ticks.main;
+            invalidate_background_layer();
         }
     }
     else if (state.slideshow_transition) {
         
         // Increase the transparency
-        slideshow->transition_alpha += slideshow->transition_change_rate;
+        float progress = get_animation_progress(&slideshow->transition);
+        mark_dirty(NULL);
         
-        // If transition is done, destroy old background and replace it with the new one
-        if (slideshow->transition_alpha >= 255.0f) {
+        // If transition is done, swap the textures so the old background is reused for the next image
+        if (progress >= 1.0f) {
             SDL_SetTextureAlphaMod(slideshow->transition_texture, 0xFF);
-            slideshow->transition_alpha = 0.0f;
-            SDL_DestroyTexture(background_texture);
+            SDL_Texture *texture = background_texture;
             background_texture = slideshow->transition_texture;
-            slideshow->transition_texture = NULL;
+            slideshow->transition_texture = texture;
+            SDL_Rect rect = slideshow->background_rect;
+            slideshow->background_rect = slideshow->transition_rect;
+            slideshow->transition_rect = rect;
             state.slideshow_transition = false;
             ticks.slideshow_load = ticks.main;
+            invalidate_background_layer();
         }
         else
-            SDL_SetTextureAlphaMod(slideshow->transition_texture, (Uint8) slideshow->transition_alpha);
+            SDL_SetTextureAlphaMod(slideshow->transition_texture, (Uint8) (255.0f * progress));
     }
 }
 
@@ -1069,6 +1950,8 @@ static void update_screensaver()
     if (!state.screensaver_active && ticks.main - ticks.last_input > config.screensaver_idle_time) {
         state.screensaver_active = true;
         state.screensaver_transition = true;
+        start_animation(&screensaver->transition, SCREENSAVER_TRANSITION_TIME);
+        mark_dirty(NULL);
         if (config.background_mode == BACKGROUND_SLIDESHOW && config.screensaver_pause_slideshow)
             state.slideshow_paused = true;
     }
@@ -1076,21 +1959,19 @@ static void update_screensaver()
 
         // Transition the screen to dark
         if (state.screensaver_transition) {
-            screensaver->alpha += screensaver->transition_change_rate;
-            if (screensaver->alpha >= screensaver->alpha_end_value) {
-                SDL_SetTextureAlphaMod(screensaver->texture, (Uint8) screensaver->alpha_end_value);
+            float progress = get_animation_progress(&screensaver->transition);
+            mark_dirty(NULL);
+            SDL_SetTextureAlphaMod(screensaver->texture, (Uint8) (screensaver->alpha_end_value * progress));
+            if (progress >= 1.0f)
                 state.screensaver_transition = false;
-            }
-            else
-                SDL_SetTextureAlphaMod(screensaver->texture, (Uint8) screensaver->alpha);
         }
 
         // User has pressed input, deactivate the screensaver
         if (state.screensaver_active && ticks.last_input == ticks.main) {
             SDL_SetTextureAlphaMod(screensaver->texture, 0);
-            screensaver->alpha = 0.0f;
             state.screensaver_active = false;
             state.screensaver_transition = false;
+            mark_dirty(NULL);
             if (config.background_mode == BACKGROUND_SLIDESHOW) {
                 state.slideshow_paused = false;
                 
@@ -1102,46 +1983,143 @@ static void update_screensaver()
     }
 }
 
+// A function to render the clock text on a worker thread
+static void render_clock_job(Job *job)
+{
+    render_clock(&((ClockJob*) job)->clock);
+}
+
+// A function to apply the rendered clock text on the main thread
+static void complete_clock_job(Job *job)
+{
+    // Take the rendered text and geometry, keeping the current textures
+    Clock *rendered = &((ClockJob*) job)->clock;
+    rendered->time_texture = clk->time_texture;
+    rendered->date_texture = clk->date_texture;
+    *clk = *rendered;
+
+    // Update textures in place
+    update_clock_textures(clk);
+    ticks.clock_update = ticks.main;
+    clk->render_time = false;
+    clk->render_date = false;
+    state.clock_rendering = false;
+    mark_dirty(&clk->previous_time_rect);
+    mark_dirty(&clk->time_rect);
+    if (config.clock_show_date) {
+        mark_dirty(&clk->previous_date_rect);
+        mark_dirty(&clk->date_rect);
+    }
+}
+
 // A function to update the clock display
 static void update_clock(bool block)
 {
-    if (ticks.main - ticks.clock_update > CLOCK_UPDATE_PERIOD) {
-        if (!state.clock_rendering) {
-
-            // Check to see if the time has changed
-            get_time(clk);
-            if (clk->render_time) {
-                state.clock_rendering = true;
-                if (block)
-                    render_clock(clk);
-                else
-                    clock_thread = SDL_CreateThread(render_clock_async, "Clock Thread", (void*) clk); 
+    if (ticks.main - ticks.clock_update > CLOCK_UPDATE_PERIOD && !state.clock_rendering) {
+
+        // Check to see if the time has changed
+        get_time(clk);
+        if (clk->render_time) {
+            state.clock_rendering = true;
+            clk->previous_time_rect = clk->time_rect;
+            clk->previous_date_rect = clk->date_rect;
+            init_job(&clock_job.job, render_clock_job, JOB_PRIORITY_HIGH);
+            clock_job.job.complete = complete_clock_job;
+            clock_job.job.finished = &completions;
+            clock_job.clock = *clk;
+            if (block) {
+                render_clock_job(&clock_job.job);
+                complete_clock_job(&clock_job.job);
             }
             else
-                ticks.clock_update = ticks.main;
+                submit_job(&clock_job.job);
         }
-
-        // Render texture
-        if (state.clock_ready) {
-            SDL_WaitThread(clock_thread, NULL);
-            clock_thread = NULL;
-            SDL_DestroyTexture(clk->time_texture);
-            clk->time_texture = load_texture(clk->time_surface);
-            clk->time_surface = NULL;
-            if (clk->render_date) {
-                SDL_DestroyTexture(clk->date_texture);
-                clk->date_texture = load_texture(clk->date_surface);
-                clk->date_surface = NULL;
-            }
+        else
             ticks.clock_update = ticks.main;
-            clk->render_time = false;
-            clk->render_date = false;
-            state.clock_rendering = false;
-            state.clock_ready = false;
-        }
     }
 }
 
+// A function to move a wait timeout forward to a deadline if it is sooner
+static void set_deadline(int *timeout, Uint32 now, Uint32 deadline)
+{
+    int remaining = (int) (deadline - now);
+    if (remaining < 0)
+        remaining = 0;
+    if (*timeout < 0 || remaining < *timeout)
+        *timeout = remaining;
+}
+
+// A function to calculate how long the main loop can sleep before
+// the next scheduled update, -1 if it can sleep until the next event
+static int calculate_wait_timeout()
+{
+    // Don't sleep if the screen is out of date or a transition is in progress
+    if (state.redraw || state.slideshow_transition || state.screensaver_transition)
+        return 0;
+
+    int timeout = -1;
+    Uint32 now = SDL_GetTicks();
+    if (state.application_launching)
+        set_deadline(&timeout, now, ticks.application_launched + config.application_timeout + 1);
+    if (state.application_running || state.application_launching)
+        return timeout;
+
+    // Keep creating prefetched textures while there are some waiting
+    if (jobs_waiting(&button_queue) || completions_waiting(&completions))
+        return 0;
+
+    // Render idle frames at a reduced rate while nothing is changing
+    if (config.idle_fps > 0)
+        set_deadline(&timeout, now, ticks.last_frame + 1000 / (Uint32) config.idle_fps);
+
+    // Wake up for the next repeat of any gamepad control that is held
+    for (GamepadControl *i = gamepad_controls; gamepads != NULL && i != NULL; i = i->next) {
+        if (i->repeat)
+            set_deadline(&timeout, now, now + get_time_until(i->repeat));
+    }
+
+    // Background threads wake the loop when they finish, so only
+    // the start of the next job needs a deadline
+    if (config.background_mode == BACKGROUND_SLIDESHOW && !state.slideshow_paused &&
+    !state.slideshow_transition && !slideshow->waiting)
+        set_deadline(&timeout, now, ticks.slideshow_load + config.slideshow_image_duration + 1);
+    if (config.screensaver_enabled && !state.screensaver_active)
+        set_deadline(&timeout, now, ticks.last_input + config.screensaver_idle_time + 1);
+    if (config.clock_enabled && !state.clock_rendering) {
+        Uint32 clock_deadline = ticks.clock_update + CLOCK_UPDATE_PERIOD + 1;
+        Uint32 minute_deadline = now + get_time_until_update();
+        set_deadline(&timeout, now, (int) (minute_deadline - clock_deadline) > 0 ? minute_deadline : clock_deadline);
+    }
+    return timeout;
+}
+
+// A function to check if an idle frame should be rendered while the screen is static
+static bool idle_frame_due()
+{
+    return config.idle_fps > 0 && ticks.main - ticks.last_frame >= 1000 / (Uint32) config.idle_fps;
+}
+
+// A function to sleep until an event arrives or the next update is due
+static void wait_for_event()
+{
+    int timeout = calculate_wait_timeout();
+    if (timeout != 0)
+        skip_frame();
+    if (timeout < 0)
+        SDL_WaitEvent(NULL);
+    else if (timeout > 0)
+        SDL_WaitEventTimeout(NULL, timeout);
+}
+
+// A function to wake the main loop from another thread
+void wake_main_loop()
+{
+    if (!config.low_power_mode)
+        return;
+    SDL_Event wake_event = { .type = SDL_USEREVENT };
+    SDL_PushEvent(&wake_event);
+}
+
 static inline void pre_launch()
 {
     if (gamepads != NULL)
@@ -1159,6 +2137,7 @@ static inline void post_launch()
     // Rebaseline the timing after the program is done
     ticks.main = SDL_GetTicks();
     ticks.last_input = ticks.main;
+    mark_dirty(NULL);
 
     // Post-application updates
     if (config.gamepad_enabled)
@@ -1187,10 +2166,11 @@ void quit(int status)
             "A critical error occurred. Check the log file for details.", 
             NULL
         );
-    if (config.quit_cmd != NULL) {
+    if (config.quit_cmd != NULL && config.compile_pack == NULL) {
         execute_command(config.quit_cmd);
         free(config.quit_cmd);
     }
+    log_stats();
     cleanup();
     exit(status);
 }
@@ -1216,10 +2196,17 @@ int main(int argc, char *argv[])
 
     // Handle command line arguments, find config file
     handle_arguments(argc, argv, &config_file_path);
+    if (config.benchmark)
+        init_benchmark();
 
     // Parse config file for settings and menu entries
     parse_config_file(config_file_path);
+    Uint64 config_hash = 0;
+    if (config.theme_pack != NULL || config.compile_pack != NULL)
+        config_hash = hash_config_file(config_file_path);
     free(config_file_path);
+    if (config.benchmark)
+        configure_benchmark();
 
     // Get default menu
     if (config.default_menu == NULL)
@@ -1232,17 +2219,74 @@ int main(int argc, char *argv[])
     init_sdl();
     init_sdl_image();
     init_sdl_ttf();
+    log_debug("Using %s pixel kernels", init_pixel_kernels()->name);
+    init_log_mutex();
+    init_job_pool();
+    if (init_job_queue(&button_queue, true))
+        log_fatal("Could not create button queue");
     validate_settings(&geo);
     
     // Initialize slideshow
     if (config.background_mode == BACKGROUND_SLIDESHOW)
         init_slideshow();
 
-    // Initialize Nanosvg, create window and renderer
+    // Initialize Nanosvg
     init_svg();
+
+    // Render every asset into a theme pack and quit
+    if (config.compile_pack != NULL) {
+        compile_theme_pack(config_hash);
+        quit(EXIT_SUCCESS);
+    }
+    if (config.theme_pack != NULL)
+        open_pack(config.theme_pack, config_hash);
+
+    // Create window and renderer
     create_window();
+    if (config.icon_cache)
+        init_icon_cache();
+
+    // Rasterize the highlight and scroll indicators on the workers while the
+    // background image and clock font are loaded
+    JobQueue svg_queue;
+    SVGJob highlight_job;
+    SVGJob scroll_job;
+    int svg_jobs = 0;
+    if (init_job_queue(&svg_queue, false))
+        log_fatal("Could not create SVG queue");
+    if (config.highlight) {
+        int width, height;
+        get_highlight_size(&width, &height);
+        highlight = malloc(sizeof(Highlight));
+        highlight->texture = NULL;
+        submit_svg_job(&highlight_job,
+            &svg_queue,
+            render_highlight,
+            PACK_ASSET_HIGHLIGHT,
+            width,
+            height,
+            &highlight->rect
+        );
+        svg_jobs++;
+    }
+    if (config.scroll_indicators) {
+        scroll = malloc(sizeof(Scroll));
+        scroll->texture = NULL;
+        submit_svg_job(&scroll_job,
+            &svg_queue,
+            render_scroll_indicator,
+            PACK_ASSET_SCROLL_INDICATOR,
+            -1,
+            get_scroll_indicator_height(),
+            &scroll->rect_right
+        );
+        svg_jobs++;
+    }
 
     // Initialize timing
+    if (config.frame_stats)
+        init_stats();
+    init_timeline();
     ticks.main = SDL_GetTicks();
     ticks.last_input = ticks.main;
     ticks.program_start = ticks.main;
@@ -1275,8 +2319,15 @@ int main(int argc, char *argv[])
 
     // Render first slideshow image
     else if (config.background_mode == BACKGROUND_SLIDESHOW) {
-        SDL_Surface *surface = load_next_slideshow_background(slideshow, false);
-        background_texture = load_texture(surface);
+        bool single = false;
+        SDL_Surface *surface = load_next_slideshow_background(slideshow, &single);
+        if (surface == NULL || single)
+            end_slideshow(surface);
+        else {
+            background_texture = create_streaming_texture(geo.screen_width, geo.screen_height);
+            update_streaming_texture(background_texture, surface, &slideshow->background_rect);
+            submit_slideshow_job();
+        }
     }
 
     // Initialize screensaver
@@ -1290,23 +2341,14 @@ int main(int argc, char *argv[])
         ticks.clock_update = ticks.main;
     }
     
-    // Render highlight
-    if (config.highlight) {
-        int button_height = config.icon_size + config.title_padding + geo.font_height;
-        highlight = malloc(sizeof(Highlight));
-        highlight->texture = render_highlight(config.icon_size + 2*config.highlight_hpadding,
-                                button_height + 2*config.highlight_vpadding,
-                                &highlight->rect
-                            );
-    }
-
-    // Render scroll indicators
-    if (config.scroll_indicators) {
-        scroll = malloc(sizeof(Scroll));
-        scroll->texture = NULL;
-        int scroll_indicator_height = (int) ((float) geo.screen_height * SCROLL_INDICATOR_HEIGHT);
-        render_scroll_indicators(scroll, scroll_indicator_height, &geo);
-    }
+    // Wait for the highlight and scroll indicators, then upload them
+    for (; svg_jobs > 0; svg_jobs--)
+        pop_job(&svg_queue);
+    destroy_job_queue(&svg_queue);
+    if (config.highlight)
+        highlight->texture = load_texture(highlight_job.surface);
+    if (config.scroll_indicators)
+        load_scroll_indicators(scroll, scroll_job.surface, &geo);
 
     // Render background overlay
     if (config.background_overlay) {
@@ -1354,7 +2396,11 @@ int main(int argc, char *argv[])
     // Main program loop
     log_debug("Begin program loop");
     while (1) {
+        if (config.low_power_mode)
+            wait_for_event();
         ticks.main = SDL_GetTicks();
+        update_timeline();
+        start_phase(PHASE_EVENTS);
         while (SDL_PollEvent(&event)) {
             switch(event.type) {
                 case SDL_QUIT:
@@ -1389,7 +2435,12 @@ int main(int argc, char *argv[])
                     }
                     break;
 
+                case SDL_RENDER_TARGETS_RESET:
+                    reset_render_targets();
+                    break;
+
                 case SDL_WINDOWEVENT:
+                    mark_dirty(NULL);
                     if (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST) {
                         log_debug("Lost keyboard focus");
                         state.has_focus = false;
@@ -1421,8 +2472,14 @@ int main(int argc, char *argv[])
 #endif
             }
         }
+        end_phase(PHASE_EVENTS);
+
+        // Run the next command of the benchmark script
+        if (config.benchmark)
+            run_benchmark_step();
 
         // Update application state
+        start_phase(PHASE_UPDATE);
         if (state.application_running && state.has_focus) {
             state.application_running = false;
             post_launch();
@@ -1431,6 +2488,7 @@ int main(int argc, char *argv[])
 
         // Post-event loop updates
         if (!(state.application_running || state.application_launching)) {
+            run_completions(&completions);
             if (gamepads != NULL)
                 poll_gamepad();
             if (config.background_mode == BACKGROUND_SLIDESHOW)
@@ -1439,16 +2497,21 @@ int main(int argc, char *argv[])
                 update_screensaver();
             if (config.clock_enabled)
                 update_clock(false);
+            update_prefetch();
         }
         if (state.application_launching &&
         ticks.main - ticks.application_launched > config.application_timeout) {
             state.application_launching = false;
+            mark_dirty(NULL);
             if (config.on_launch == ON_LAUNCH_BLANK)
                 set_draw_color();
         }
-        if (state.application_running)
+        end_phase(PHASE_UPDATE);
+        if (state.application_running) {
+            skip_frame();
             SDL_Delay(APPLICATION_WAIT_PERIOD);
-        else
+        }
+        else if (state.redraw || !config.low_power_mode || idle_frame_due())
             draw_screen();
     }
     quit(EXIT_SUCCESS);
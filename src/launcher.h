@@ -38,6 +38,13 @@
 #define APPLICATION_WAIT_PERIOD 100
 #define MIN_APPLICATION_TIMEOUT 3
 #define MAX_APPLICATION_TIMEOUT 30
+#define MAX_DIRTY_RECTS 16
+#define FRAME_PACER_SPIN_TIME 2
+#define MAX_IDLE_FPS 30
+#define PAGE_RESIDENCY_RADIUS 1
+#define PAGE_RELEASE_DISTANCE 2
+#define PREFETCH_UPLOADS_PER_FRAME 4
+#define SLIDESHOW_PREFETCH_DEPTH 2
 
 // Special commands
 #define SCMD_SELECT ":select"
@@ -52,6 +59,7 @@
 #define SCMD_SHUTDOWN ":shutdown"
 #define SCMD_RESTART ":restart"
 #define SCMD_SLEEP ":sleep"
+#define SCMD_STATS ":stats"
 
 typedef enum {
     MODE_SETTING_BACKGROUND,
@@ -115,15 +123,27 @@ typedef struct {
     bool application_running;
     bool has_focus;
     bool slideshow_transition;
-    bool slideshow_background_rendering;
-    bool slideshow_background_ready;
     bool slideshow_paused;
     bool screensaver_active;
     bool screensaver_transition;
     bool clock_rendering;
-    bool clock_ready;
+    bool redraw;
+    bool background_layer_stale;
 } State;
 
+// High resolution frame pacing
+typedef struct {
+    Uint64 frequency;
+    Uint64 period;
+    Uint64 deadline;
+} FramePacer;
+
+// Animation with a fixed duration on the animation timeline
+typedef struct {
+    Uint64 start;
+    Uint64 duration;
+} Animation;
+
 // Timing information
 typedef struct {
     Uint32 main;
@@ -133,8 +153,32 @@ typedef struct {
     Uint32 last_input;
     Uint32 clock_update;
     Uint32 application_exited;
+    Uint32 last_frame;
 } Ticks;
 
+// Linked list of textures holding a grid of shared icons, so that
+// the icons of a page can be drawn with few texture changes
+typedef struct icon_atlas {
+    SDL_Texture       *texture;
+    int               columns;
+    int               rows;
+    int               used; // Number of occupied slots
+    bool              *slots;
+    struct icon_atlas *next;
+} IconAtlas;
+
+// Linked list of textures shared between every entry that uses the same image file
+typedef struct shared_texture {
+    char                  *path;
+    SDL_Texture           *texture;
+    SDL_Rect              clip; // Area of the texture holding the image
+    IconAtlas             *atlas; // Atlas holding the image, NULL if it has its own texture
+    int                   slot;
+    int                   references;
+    void                  *loader; // Job decoding the image, NULL once loaded
+    struct shared_texture *next;
+} SharedTexture;
+
 // Linked list for menu entries
 typedef struct entry {
     char           *title;
@@ -143,19 +187,35 @@ typedef struct entry {
     char           *cmd;
     SDL_Texture    *icon;
     SDL_Texture    *icon_selected;
+    SharedTexture  *icon_shared;
+    SharedTexture  *icon_selected_shared;
+    SDL_Rect       icon_clip;
+    SDL_Rect       icon_selected_clip;
     SDL_Rect       icon_rect;
     SDL_Texture    *title_texture;
+    SDL_Rect       title_clip;
     SDL_Rect       text_rect;
     int            title_offset;
     struct entry   *next;
     struct entry   *previous;
 } Entry;
 
+// Textures for one page of a menu
+typedef struct {
+    SDL_Texture  **atlases;
+    int          num_atlases;
+    bool         rendered;
+    void         *jobs; // Button jobs while the page is being rendered
+    int          pending_jobs;
+} MenuPage;
+
 // Linked list for menus
 typedef struct menu {
     char         *name;
     unsigned int num_entries;
-    bool         rendered;
+    MenuPage     *pages;
+    unsigned int num_pages;
+    Uint64       last_shown;
     unsigned int page;
     unsigned int highlight_position;
     Entry        *first_entry;
@@ -177,7 +237,7 @@ typedef struct gamepad {
 typedef struct gamepad_control {
     ControlType            type;
     int                    index;
-    Uint32                 repeat;
+    Uint64                 repeat; // Time of the next repeat, 0 if not held
     const char             *label;
     char                   *cmd;
     struct gamepad_control *next;
@@ -215,23 +275,42 @@ typedef struct {
     SDL_Rect rect_left;
 } Scroll;
 
+// Regions of the screen that need to be redrawn
+typedef struct {
+    SDL_Rect rects[MAX_DIRTY_RECTS];
+    int num_rects;
+    bool full_screen;
+} DirtyRegion;
+
+// Slideshow image decoded ahead of time
+typedef struct {
+    SDL_Surface *surface;
+    Uint64 decode_time; // Performance counter ticks
+} SlideshowImage;
+
 // Slideshow
 typedef struct {
     char **images;
     int *order;
-    int i;
+    int i; // Index of the last image decoded
     int num_images;
-    float transition_alpha;
-    float transition_change_rate;
-    SDL_Surface *transition_surface;
+    Animation transition;
     SDL_Texture *transition_texture;
+    SDL_Rect background_rect; // Area of each streaming texture holding its image
+    SDL_Rect transition_rect;
+    SlideshowImage ring[SLIDESHOW_PREFETCH_DEPTH];
+    int ring_head;
+    int ring_count;
+    bool decoding; // A job is decoding the next image
+    bool waiting; // The next image was due before it was decoded
+    bool ended; // Fewer than two images could be loaded, so no more are decoded
+    SDL_Surface *final_surface; // Only valid image when ended, shown once the ring is empty
 } Slideshow;
 
 // Screensaver
 typedef struct {
-    float alpha;
     float alpha_end_value;
-    float transition_change_rate;
+    Animation transition;
     SDL_Texture *texture;
 } Screensaver;
 
@@ -241,7 +320,14 @@ typedef struct {
     unsigned int max_buttons;
     bool vsync;
     int fps_limit;
+    bool precise_frame_pacing;
     Uint32 application_timeout;
+    bool low_power_mode;
+    bool icon_cache;
+    Uint64 texture_budget; // Bytes, 0 if unlimited
+    char *theme_pack; // Path to precompiled theme pack
+    int idle_fps; // Frame rate while the screen is static in low power mode, 0 to stop rendering
+    bool frame_stats;
     ModeBackground background_mode; // Defines image or color background mode
     SDL_Color background_color; // Background color
     SDL_Color chroma_key_color;
@@ -292,6 +378,14 @@ typedef struct {
     int gamepad_device;
     char *gamepad_mappings_file;
     bool debug;
+    bool benchmark;
+    int benchmark_frames;
+    char *benchmark_screenshot;
+    char *benchmark_reference;
+    double benchmark_max_first_frame;
+    double benchmark_max_draw;
+    Sint64 benchmark_time; // Fixed clock time in seconds since the epoch, 0 for the real time
+    char *compile_pack; // Path to write a theme pack to, then quit
     char *exe_path;
     Menu *first_menu;
     size_t num_menus;
@@ -315,5 +409,7 @@ typedef struct {
 
 void quit_slideshow(void);
 void set_draw_color(void);
+void wake_main_loop(void);
+void mark_dirty(const SDL_Rect *rect);
 void quit(int status);
 void print_version(FILE *stream);
@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <SDL.h>
+#include "launcher.h"
+#include <launcher_config.h>
+#include "pack.h"
+#include "cache.h"
+#include "util.h"
+#include "debug.h"
+#include "platform/platform.h"
+
+static Uint64 get_pixel_size(int width, int height);
+static size_t align_offset(size_t offset);
+static bool validate_pack(const Uint8 *data, size_t size, Uint64 config_hash);
+static const PackAsset *find_pack_asset(PackAssetType type, const char *key);
+static void free_pack_items(void);
+
+extern Config config;
+extern Geometry geo;
+
+// The theme pack stays mapped for the life of the program, because the
+// surfaces loaded from it point straight at the mapped pixels
+static Uint8 *pack_data = NULL;
+static size_t pack_size = 0;
+static PackItem *pack_items = NULL;
+static Uint32 num_pack_items = 0;
+
+// A function to hash the contents of the config file with FNV-1a, so that
+// a theme pack is only used with the config it was compiled from
+Uint64 hash_config_file(const char *path)
+{
+    Uint64 hash = FNV_OFFSET_BASIS;
+    size_t size = 0;
+    const Uint8 *data = map_file(path, &size);
+    if (data == NULL)
+        return hash;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    unmap_file((void*) data, size);
+    return hash;
+}
+
+// A function to get the size of the pixel data of an asset
+static Uint64 get_pixel_size(int width, int height)
+{
+    return (Uint64) width * (Uint64) height * 4;
+}
+
+// A function to round an offset up to the pixel data alignment
+static size_t align_offset(size_t offset)
+{
+    return (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+}
+
+// A function to check that a theme pack matches the current config and screen,
+// and that every asset lies within the file
+static bool validate_pack(const Uint8 *data, size_t size, Uint64 config_hash)
+{
+    const PackHeader *header = (const PackHeader*) data;
+    if (size < sizeof(PackHeader) ||
+    header->magic != PACK_MAGIC ||
+    header->version != PACK_VERSION ||
+    size < sizeof(PackHeader) + (Uint64) header->num_assets * sizeof(PackAsset))
+        return false;
+    if (header->config_hash != config_hash ||
+    header->screen_width != geo.screen_width ||
+    header->screen_height != geo.screen_height)
+        return false;
+
+    const PackAsset *assets = (const PackAsset*) (data + sizeof(PackHeader));
+    for (Uint32 i = 0; i < header->num_assets; i++) {
+        const PackAsset *asset = assets + i;
+        if (asset->format != PACK_FORMAT ||
+        asset->width <= 0 ||
+        asset->height <= 0 ||
+        asset->key_offset + asset->key_length > size ||
+        asset->pixel_offset % PACK_ALIGNMENT ||
+        asset->pixel_offset + get_pixel_size(asset->width, asset->height) > size)
+            return false;
+    }
+    return true;
+}
+
+// A function to map a theme pack into memory. The pack is ignored if it was
+// compiled from a different config or for a different screen
+void open_pack(const char *path, Uint64 config_hash)
+{
+    size_t size = 0;
+    Uint8 *data = map_file(path, &size);
+    if (data == NULL) {
+        log_error("Could not open theme pack %s", path);
+        return;
+    }
+    if (!validate_pack(data, size, config_hash)) {
+        log_error("Theme pack %s does not match the config file or screen, "
+                  "recompile it with --compile-pack",
+            path
+        );
+        unmap_file(data, size);
+        return;
+    }
+    pack_data = data;
+    pack_size = size;
+    log_debug("Loaded theme pack %s with %u assets",
+        path,
+        ((const PackHeader*) data)->num_assets
+    );
+}
+
+// A function to unmap the theme pack
+void close_pack()
+{
+    if (pack_data != NULL) {
+        unmap_file(pack_data, pack_size);
+        pack_data = NULL;
+        pack_size = 0;
+    }
+}
+
+// A function to find an asset in the theme pack
+static const PackAsset *find_pack_asset(PackAssetType type, const char *key)
+{
+    const PackHeader *header = (const PackHeader*) pack_data;
+    const PackAsset *assets = (const PackAsset*) (pack_data + sizeof(PackHeader));
+    size_t key_length = strlen(key);
+    for (Uint32 i = 0; i < header->num_assets; i++) {
+        if (assets[i].type == (Uint32) type &&
+        assets[i].key_length == key_length &&
+        !memcmp(pack_data + assets[i].key_offset, key, key_length))
+            return assets + i;
+    }
+    return NULL;
+}
+
+// A function to load an asset from the theme pack. The surface uses the mapped
+// pixels directly and must not be modified. Icons are skipped if the image file
+// changed since the pack was compiled. This is safe to call from worker threads
+SDL_Surface *load_pack_asset(PackAssetType type, const char *key, int *text_height)
+{
+    if (pack_data == NULL)
+        return NULL;
+    if (key == NULL)
+        key = "";
+    const PackAsset *asset = find_pack_asset(type, key);
+    if (asset == NULL)
+        return NULL;
+    if (type == PACK_ASSET_ICON) {
+        Uint64 mtime, size;
+        if (!get_file_info(key, &mtime, &size) || mtime != asset->mtime || size != asset->size)
+            return NULL;
+    }
+    if (text_height != NULL)
+        *text_height = asset->text_height;
+    return SDL_CreateRGBSurfaceWithFormatFrom(pack_data + asset->pixel_offset,
+               asset->width,
+               asset->height,
+               32,
+               asset->width * 4,
+               asset->format
+           );
+}
+
+// A function to determine if an asset has already been added to the pack being compiled
+bool has_pack_asset(PackAssetType type, const char *key)
+{
+    if (key == NULL)
+        key = "";
+    for (PackItem *item = pack_items; item != NULL; item = item->next) {
+        if (item->type == type && !strcmp(item->key, key))
+            return true;
+    }
+    return false;
+}
+
+// A function to add a rendered asset to the pack being compiled. The pack takes
+// ownership of the surface, which is converted to the upload format
+void add_pack_asset(PackAssetType type, const char *key, SDL_Surface *surface, int text_height)
+{
+    if (surface == NULL)
+        return;
+    if (key == NULL)
+        key = "";
+    if (surface->format->format != PACK_FORMAT) {
+        SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, PACK_FORMAT, 0);
+        SDL_FreeSurface(surface);
+        if (converted == NULL) {
+            log_error("Could not convert pack asset %s\n%s", key, SDL_GetError());
+            return;
+        }
+        surface = converted;
+    }
+
+    PackItem *item = malloc(sizeof(PackItem));
+    item->type = type;
+    item->key = strdup(key);
+    item->surface = surface;
+    item->text_height = text_height;
+    item->mtime = 0;
+    item->size = 0;
+    if (type == PACK_ASSET_ICON)
+        get_file_info(key, &item->mtime, &item->size);
+    item->next = pack_items;
+    pack_items = item;
+    num_pack_items++;
+}
+
+// A function to free the assets of the pack being compiled
+static void free_pack_items()
+{
+    PackItem *item = pack_items;
+    while (item != NULL) {
+        PackItem *next = item->next;
+        SDL_FreeSurface(item->surface);
+        free(item->key);
+        free(item);
+        item = next;
+    }
+    pack_items = NULL;
+    num_pack_items = 0;
+}
+
+// A function to write the compiled assets to a theme pack file
+int write_pack(const char *path, Uint64 config_hash)
+{
+    // Write to a temporary file first so a partially written pack is never read
+    char tmp_path[MAX_PATH_CHARS + 1];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *file = fopen(tmp_path, "wb");
+    if (file == NULL) {
+        log_error("Could not write theme pack %s", tmp_path);
+        free_pack_items();
+        return 1;
+    }
+
+    // Lay out the asset table, then the keys, then the aligned pixel data
+    PackHeader header = {
+        .magic = PACK_MAGIC,
+        .version = PACK_VERSION,
+        .config_hash = config_hash,
+        .screen_width = geo.screen_width,
+        .screen_height = geo.screen_height,
+        .num_assets = num_pack_items,
+        .reserved = 0
+    };
+    PackAsset *assets = calloc(num_pack_items + 1, sizeof(PackAsset));
+    size_t offset = sizeof(PackHeader) + num_pack_items * sizeof(PackAsset);
+    Uint32 i = 0;
+    for (PackItem *item = pack_items; item != NULL; item = item->next, i++) {
+        assets[i].type = (Uint32) item->type;
+        assets[i].key_length = (Uint32) strlen(item->key);
+        assets[i].key_offset = offset;
+        offset += assets[i].key_length;
+    }
+    size_t position = offset;
+    i = 0;
+    for (PackItem *item = pack_items; item != NULL; item = item->next, i++) {
+        offset = align_offset(offset);
+        assets[i].pixel_offset = offset;
+        assets[i].mtime = item->mtime;
+        assets[i].size = item->size;
+        assets[i].width = item->surface->w;
+        assets[i].height = item->surface->h;
+        assets[i].text_height = item->text_height;
+        assets[i].format = item->surface->format->format;
+        offset += get_pixel_size(item->surface->w, item->surface->h);
+    }
+
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(assets, sizeof(PackAsset), num_pack_items, file) == num_pack_items;
+    for (PackItem *item = pack_items; success && item != NULL; item = item->next)
+        success = fwrite(item->key, 1, strlen(item->key), file) == strlen(item->key);
+    i = 0;
+    static const Uint8 padding[PACK_ALIGNMENT] = {0};
+    for (PackItem *item = pack_items; success && item != NULL; item = item->next, i++) {
+        size_t padding_length = (size_t) assets[i].pixel_offset - position;
+        success = fwrite(padding, 1, padding_length, file) == padding_length;
+        SDL_Surface *surface = item->surface;
+        position = (size_t) (assets[i].pixel_offset + get_pixel_size(surface->w, surface->h));
+        for (int y = 0; success && y < surface->h; y++)
+            success = fwrite((Uint8*) surface->pixels + y*surface->pitch, 4, (size_t) surface->w, file) == (size_t) surface->w;
+    }
+    fclose(file);
+    free(assets);
+
+    if (success) {
+        remove(path);
+        rename(tmp_path, path);
+        log_debug("Wrote theme pack %s with %u assets", path, num_pack_items);
+    }
+    else {
+        log_error("Could not write theme pack %s", path);
+        remove(tmp_path);
+    }
+    free_pack_items();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#define PACK_MAGIC 0x4B504C46 // "FLPK"
+#define PACK_VERSION 1
+#define PACK_ALIGNMENT 16
+#define PACK_FORMAT SDL_PIXELFORMAT_ARGB8888
+
+// Rendered assets that can be stored in a theme pack
+typedef enum {
+    PACK_ASSET_ICON,
+    PACK_ASSET_TITLE,
+    PACK_ASSET_HIGHLIGHT,
+    PACK_ASSET_SCROLL_INDICATOR
+} PackAssetType;
+
+// Header at the start of a theme pack file
+typedef struct {
+    Uint32 magic;
+    Uint32 version;
+    Uint64 config_hash;
+    Sint32 screen_width;
+    Sint32 screen_height;
+    Uint32 num_assets;
+    Uint32 reserved;
+} PackHeader;
+
+// Asset table entry following the header. Offsets are from the start of the file
+typedef struct {
+    Uint32 type;
+    Uint32 key_length;
+    Uint64 key_offset;
+    Uint64 pixel_offset;
+    Uint64 mtime; // Modification time and size of the source image of an icon
+    Uint64 size;
+    Sint32 width;
+    Sint32 height;
+    Sint32 text_height;
+    Uint32 format;
+} PackAsset;
+
+// Linked list of the assets rendered while compiling a theme pack
+typedef struct pack_item {
+    PackAssetType    type;
+    char             *key;
+    SDL_Surface      *surface;
+    int              text_height;
+    Uint64           mtime;
+    Uint64           size;
+    struct pack_item *next;
+} PackItem;
+
+Uint64 hash_config_file(const char *path);
+void open_pack(const char *path, Uint64 config_hash);
+void close_pack(void);
+SDL_Surface *load_pack_asset(PackAssetType type, const char *key, int *text_height);
+bool has_pack_asset(PackAssetType type, const char *key);
+void add_pack_asset(PackAssetType type, const char *key, SDL_Surface *surface, int text_height);
+int write_pack(const char *path, Uint64 config_hash);
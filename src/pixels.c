@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <SDL.h>
+#include "launcher.h"
+#include "pixels.h"
+#include "util.h"
+#ifdef PIXELS_X86
+#include <immintrin.h>
+#endif
+
+#if defined(PIXELS_X86) && defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+static inline Uint32 mul_div_255(Uint32 x);
+static void rgb24_to_argb_scalar(const Uint8 *src, Uint32 *dst, int count);
+static void premultiply_scalar(const Uint32 *src, Uint32 *dst, int count);
+static void blend_scalar(const Uint32 *src, Uint32 *dst, int count);
+static void resample_row_scalar(const float *src, float *dst, const FilterWeights *filter, int count);
+static void accumulate_row_scalar(const float *src, float *dst, float weight, int count);
+static float lanczos(float x);
+
+// Kernels for every instruction set, and the ones chosen for this CPU. The
+// results of all kernels are identical, so they can be used interchangeably
+static PixelKernels kernels[NUM_PIXEL_ISAS];
+static bool supported[NUM_PIXEL_ISAS];
+static const PixelKernels *pixel_kernels = &kernels[PIXEL_ISA_SCALAR];
+
+// A function to divide a product of two 8-bit values by 255, rounded to nearest
+static inline Uint32 mul_div_255(Uint32 x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// A function to expand RGB24 pixels to opaque ARGB8888
+static void rgb24_to_argb_scalar(const Uint8 *src, Uint32 *dst, int count)
+{
+    for (int i = 0; i < count; i++, src += 3)
+        dst[i] = 0xFF000000 | (Uint32) src[0] << 16 | (Uint32) src[1] << 8 | (Uint32) src[2];
+}
+
+// A function to multiply the color channels of ARGB8888 pixels by their alpha.
+// This is the same as blending the pixels onto a transparent surface
+static void premultiply_scalar(const Uint32 *src, Uint32 *dst, int count)
+{
+    for (int i = 0; i < count; i++) {
+        Uint32 a = src[i] >> 24;
+        dst[i] = a << 24 |
+                 mul_div_255((src[i] >> 16 & 0xFF) * a) << 16 |
+                 mul_div_255((src[i] >> 8 & 0xFF) * a) << 8 |
+                 mul_div_255((src[i] & 0xFF) * a);
+    }
+}
+
+// A function to blend ARGB8888 pixels onto others with the source alpha,
+// the same way as SDL_BLENDMODE_BLEND
+static void blend_scalar(const Uint32 *src, Uint32 *dst, int count)
+{
+    for (int i = 0; i < count; i++) {
+        Uint32 a = src[i] >> 24;
+        if (a == 0)
+            continue;
+        if (a == 0xFF) {
+            dst[i] = src[i];
+            continue;
+        }
+        Uint32 inverse = 0xFF - a;
+        dst[i] = mul_div_255(0xFF * a + (dst[i] >> 24) * inverse) << 24 |
+                 mul_div_255((src[i] >> 16 & 0xFF) * a + (dst[i] >> 16 & 0xFF) * inverse) << 16 |
+                 mul_div_255((src[i] >> 8 & 0xFF) * a + (dst[i] >> 8 & 0xFF) * inverse) << 8 |
+                 mul_div_255((src[i] & 0xFF) * a + (dst[i] & 0xFF) * inverse);
+    }
+}
+
+// A function to filter a row of pixels with 4 float channels along its length,
+// summing the weighted source pixels of each output pixel
+static void resample_row_scalar(const float *src, float *dst, const FilterWeights *filter, int count)
+{
+    for (int x = 0; x < count; x++) {
+        const float *weight = filter->weights + x*filter->max_count;
+        const float *in = src + 4*filter->start[x];
+        float sum[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+        for (int i = 0; i < filter->count[x]; i++) {
+            for (int c = 0; c < 4; c++)
+                sum[c] += weight[i] * in[4*i + c];
+        }
+        for (int c = 0; c < 4; c++)
+            dst[4*x + c] = sum[c];
+    }
+}
+
+// A function to add a weighted row of floats to another
+static void accumulate_row_scalar(const float *src, float *dst, float weight, int count)
+{
+    for (int i = 0; i < count; i++)
+        dst[i] += weight * src[i];
+}
+
+#ifdef PIXELS_X86
+// The SIMD kernels widen each channel to 16 bits. The alpha lane is forced to
+// 255 in one of the factors so that the same arithmetic produces the alpha result
+
+TARGET_SSE2 static inline __m128i mul_div_255_sse2(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+TARGET_SSE2 static inline __m128i broadcast_alpha_sse2(__m128i x)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+TARGET_SSE2 static inline __m128i premultiply_half_sse2(__m128i x)
+{
+    __m128i alpha = _mm_or_si128(broadcast_alpha_sse2(x), _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0));
+    return mul_div_255_sse2(_mm_mullo_epi16(x, alpha));
+}
+
+TARGET_SSE2 static inline __m128i blend_half_sse2(__m128i s, __m128i d)
+{
+    __m128i alpha = broadcast_alpha_sse2(s);
+    __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    s = _mm_or_si128(s, _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0));
+    return mul_div_255_sse2(_mm_add_epi16(_mm_mullo_epi16(s, alpha), _mm_mullo_epi16(d, inverse)));
+}
+
+// A function to premultiply ARGB8888 pixels 4 at a time with SSE2
+TARGET_SSE2 static void premultiply_sse2(const Uint32 *src, Uint32 *dst, int count)
+{
+    __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i lo = premultiply_half_sse2(_mm_unpacklo_epi8(x, zero));
+        __m128i hi = premultiply_half_sse2(_mm_unpackhi_epi8(x, zero));
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+    premultiply_scalar(src + i, dst + i, count - i);
+}
+
+// A function to blend ARGB8888 pixels 4 at a time with SSE2
+TARGET_SSE2 static void blend_sse2(const Uint32 *src, Uint32 *dst, int count)
+{
+    __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*) (dst + i));
+        __m128i lo = blend_half_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        __m128i hi = blend_half_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+    blend_scalar(src + i, dst + i, count - i);
+}
+
+// A function to sum the weighted taps of one resampled pixel with SSE2. Each tap
+// is one pixel in a register, so the channels are summed in the same order as the scalar kernel
+TARGET_SSE2 static inline __m128 resample_taps_sse2(const float *in, const float *weight, int first, int last, __m128 sum)
+{
+    for (int i = first; i < last; i++)
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weight[i]), _mm_loadu_ps(in + 4*i)));
+    return sum;
+}
+
+// A function to filter a row of float pixels one pixel at a time with SSE2
+TARGET_SSE2 static void resample_row_sse2(const float *src, float *dst, const FilterWeights *filter, int count)
+{
+    for (int x = 0; x < count; x++) {
+        const float *weight = filter->weights + x*filter->max_count;
+        const float *in = src + 4*filter->start[x];
+        _mm_storeu_ps(dst + 4*x, resample_taps_sse2(in, weight, 0, filter->count[x], _mm_setzero_ps()));
+    }
+}
+
+// A function to add a weighted row of floats to another 4 at a time with SSE2
+TARGET_SSE2 static void accumulate_row_sse2(const float *src, float *dst, float weight, int count)
+{
+    __m128 w = _mm_set1_ps(weight);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(w, _mm_loadu_ps(src + i))));
+    accumulate_row_scalar(src + i, dst + i, weight, count - i);
+}
+
+TARGET_AVX2 static inline __m256i mul_div_255_avx2(__m256i x)
+{
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+TARGET_AVX2 static inline __m256i broadcast_alpha_avx2(__m256i x)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+TARGET_AVX2 static inline __m256i alpha_lanes_avx2(void)
+{
+    return _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+}
+
+TARGET_AVX2 static inline __m256i premultiply_half_avx2(__m256i x)
+{
+    __m256i alpha = _mm256_or_si256(broadcast_alpha_avx2(x), alpha_lanes_avx2());
+    return mul_div_255_avx2(_mm256_mullo_epi16(x, alpha));
+}
+
+TARGET_AVX2 static inline __m256i blend_half_avx2(__m256i s, __m256i d)
+{
+    __m256i alpha = broadcast_alpha_avx2(s);
+    __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+    s = _mm256_or_si256(s, alpha_lanes_avx2());
+    return mul_div_255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(s, alpha), _mm256_mullo_epi16(d, inverse)));
+}
+
+// A function to expand RGB24 pixels to ARGB8888 8 at a time with AVX2. Each
+// 128-bit lane shuffles 4 pixels, so a lane reads 16 bytes to use 12 of them
+TARGET_AVX2 static void rgb24_to_argb_avx2(const Uint8 *src, Uint32 *dst, int count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                                             2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m256i opaque = _mm256_set1_epi32((int) 0xFF000000);
+    int i = 0;
+
+    // Stop while there are still 2 pixels to spare, so the last load stays in the row
+    for (; i + 10 <= count; i += 8) {
+        const Uint8 *p = src + 3*i;
+        __m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) p)),
+                        _mm_loadu_si128((const __m128i*) (p + 12)),
+                        1
+                    );
+        x = _mm256_or_si256(_mm256_shuffle_epi8(x, shuffle), opaque);
+        _mm256_storeu_si256((__m256i*) (dst + i), x);
+    }
+    rgb24_to_argb_scalar(src + 3*i, dst + i, count - i);
+}
+
+// A function to premultiply ARGB8888 pixels 8 at a time with AVX2
+TARGET_AVX2 static void premultiply_avx2(const Uint32 *src, Uint32 *dst, int count)
+{
+    __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i lo = premultiply_half_avx2(_mm256_unpacklo_epi8(x, zero));
+        __m256i hi = premultiply_half_avx2(_mm256_unpackhi_epi8(x, zero));
+        _mm256_storeu_si256((__m256i*) (dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    premultiply_scalar(src + i, dst + i, count - i);
+}
+
+// A function to blend ARGB8888 pixels 8 at a time with AVX2
+TARGET_AVX2 static void blend_avx2(const Uint32 *src, Uint32 *dst, int count)
+{
+    __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*) (dst + i));
+        __m256i lo = blend_half_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+        __m256i hi = blend_half_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+        _mm256_storeu_si256((__m256i*) (dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    blend_scalar(src + i, dst + i, count - i);
+}
+
+// A function to filter a row of float pixels 2 at a time with AVX2. Each 128-bit
+// lane sums the taps of one output pixel, and the taps that only one of the pixels
+// has are summed separately, so the result is the same as the scalar kernel
+TARGET_AVX2 static void resample_row_avx2(const float *src, float *dst, const FilterWeights *filter, int count)
+{
+    int x = 0;
+    for (; x + 2 <= count; x += 2) {
+        const float *weight0 = filter->weights + x*filter->max_count;
+        const float *weight1 = weight0 + filter->max_count;
+        const float *in0 = src + 4*filter->start[x];
+        const float *in1 = src + 4*filter->start[x + 1];
+        int taps = MIN(filter->count[x], filter->count[x + 1]);
+        __m256 sum = _mm256_setzero_ps();
+        for (int i = 0; i < taps; i++) {
+            __m256 w = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(weight0[i])), _mm_set1_ps(weight1[i]), 1);
+            __m256 p = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in0 + 4*i)), _mm_loadu_ps(in1 + 4*i), 1);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(w, p));
+        }
+        __m128 sum0 = resample_taps_sse2(in0, weight0, taps, filter->count[x], _mm256_castps256_ps128(sum));
+        __m128 sum1 = resample_taps_sse2(in1, weight1, taps, filter->count[x + 1], _mm256_extractf128_ps(sum, 1));
+        _mm_storeu_ps(dst + 4*x, sum0);
+        _mm_storeu_ps(dst + 4*x + 4, sum1);
+    }
+    for (; x < count; x++) {
+        const float *weight = filter->weights + x*filter->max_count;
+        const float *in = src + 4*filter->start[x];
+        _mm_storeu_ps(dst + 4*x, resample_taps_sse2(in, weight, 0, filter->count[x], _mm_setzero_ps()));
+    }
+}
+
+// A function to add a weighted row of floats to another 8 at a time with AVX2
+TARGET_AVX2 static void accumulate_row_avx2(const float *src, float *dst, float weight, int count)
+{
+    __m256 w = _mm256_set1_ps(weight);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(w, _mm256_loadu_ps(src + i))));
+    accumulate_row_scalar(src + i, dst + i, weight, count - i);
+}
+#endif
+
+// A function to choose the fastest pixel kernels the CPU supports, and return them
+const PixelKernels *init_pixel_kernels()
+{
+    kernels[PIXEL_ISA_SCALAR] = (PixelKernels) {
+        .name = "Scalar",
+        .rgb24_to_argb = rgb24_to_argb_scalar,
+        .premultiply = premultiply_scalar,
+        .blend = blend_scalar,
+        .resample_row = resample_row_scalar,
+        .accumulate_row = accumulate_row_scalar
+    };
+    supported[PIXEL_ISA_SCALAR] = true;
+    pixel_kernels = &kernels[PIXEL_ISA_SCALAR];
+#ifdef PIXELS_X86
+
+    // SSE2 has no byte shuffle, so the RGB24 expansion stays scalar
+    kernels[PIXEL_ISA_SSE2] = (PixelKernels) {
+        .name = "SSE2",
+        .rgb24_to_argb = rgb24_to_argb_scalar,
+        .premultiply = premultiply_sse2,
+        .blend = blend_sse2,
+        .resample_row = resample_row_sse2,
+        .accumulate_row = accumulate_row_sse2
+    };
+    kernels[PIXEL_ISA_AVX2] = (PixelKernels) {
+        .name = "AVX2",
+        .rgb24_to_argb = rgb24_to_argb_avx2,
+        .premultiply = premultiply_avx2,
+        .blend = blend_avx2,
+        .resample_row = resample_row_avx2,
+        .accumulate_row = accumulate_row_avx2
+    };
+    supported[PIXEL_ISA_SSE2] = SDL_HasSSE2();
+    supported[PIXEL_ISA_AVX2] = SDL_HasAVX2();
+    for (int isa = NUM_PIXEL_ISAS - 1; isa > PIXEL_ISA_SCALAR; isa--) {
+        if (supported[isa]) {
+            pixel_kernels = &kernels[isa];
+            break;
+        }
+    }
+#endif
+    return pixel_kernels;
+}
+
+// A function to get the kernels of an instruction set, or NULL if the CPU doesn't support it
+const PixelKernels *get_pixel_kernels(PixelISA isa)
+{
+    return supported[isa] ? &kernels[isa] : NULL;
+}
+
+// A function to evaluate the Lanczos windowed sinc filter
+static float lanczos(float x)
+{
+    if (x == 0.0F)
+        return 1.0F;
+    if (x <= -LANCZOS_RADIUS || x >= LANCZOS_RADIUS)
+        return 0.0F;
+    float pix = LANCZOS_PI * x;
+    return LANCZOS_RADIUS * sinf(pix) * sinf(pix / LANCZOS_RADIUS) / (pix * pix);
+}
+
+// A function to free the filter weights for one axis
+void free_filter_weights(FilterWeights *filter)
+{
+    free(filter->start);
+    free(filter->count);
+    free(filter->weights);
+}
+
+// A function to calculate the normalized filter weights of the source pixels
+// that contribute to each output pixel along one axis. When downscaling the
+// filter is stretched to cover every source pixel, like an area filter
+bool calculate_filter_weights(FilterWeights *filter, int source, int output)
+{
+    float scale = (float) source / (float) output;
+    float stretch = MAX(scale, 1.0F);
+    float support = LANCZOS_RADIUS * stretch;
+    filter->max_count = 2 * (int) ceilf(support) + 2;
+    filter->start = malloc((size_t) output * sizeof(int));
+    filter->count = malloc((size_t) output * sizeof(int));
+    filter->weights = malloc((size_t) output * (size_t) filter->max_count * sizeof(float));
+    if (filter->start == NULL || filter->count == NULL || filter->weights == NULL) {
+        free_filter_weights(filter);
+        return false;
+    }
+
+    for (int i = 0; i < output; i++) {
+        float center = ((float) i + 0.5F) * scale;
+        int first = MAX((int) floorf(center - support), 0);
+        int last = MIN((int) ceilf(center + support), source);
+        float *weights = filter->weights + i*filter->max_count;
+        float total = 0.0F;
+        int count = 0;
+        for (int j = first; j < last && count < filter->max_count; j++, count++) {
+            weights[count] = lanczos(((float) j + 0.5F - center) / stretch);
+            total += weights[count];
+        }
+        if (total != 0.0F) {
+            for (int j = 0; j < count; j++)
+                weights[j] /= total;
+        }
+        filter->start[i] = first;
+        filter->count[i] = count;
+    }
+    return true;
+}
+
+// A function to filter a row of float pixels with the fastest kernel
+void resample_row(const float *src, float *dst, const FilterWeights *filter, int count)
+{
+    pixel_kernels->resample_row(src, dst, filter, count);
+}
+
+// A function to add a weighted row of floats to another with the fastest kernel
+void accumulate_row(const float *src, float *dst, float weight, int count)
+{
+    pixel_kernels->accumulate_row(src, dst, weight, count);
+}
+
+// A function to expand rows of RGB24 pixels to opaque ARGB8888
+void convert_rgb24_rows(const Uint8 *src, int src_pitch, Uint32 *dst, int dst_pitch, int w, int h)
+{
+    for (int y = 0; y < h; y++) {
+        pixel_kernels->rgb24_to_argb(src, dst, w);
+        src += src_pitch;
+        dst = (Uint32*) ((Uint8*) dst + dst_pitch);
+    }
+}
+
+// A function to compose text with its shadow, offset down and to the right. Both
+// surfaces must be ARGB8888, as rendered by TTF_RenderUTF8_Blended. The result
+// is the same as blitting the shadow and then the text onto a transparent surface
+SDL_Surface *compose_text_shadow(SDL_Surface *foreground, SDL_Surface *shadow, int offset)
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0,
+                               foreground->w + offset,
+                               foreground->h + offset,
+                               32,
+                               SDL_PIXELFORMAT_ARGB8888
+                           );
+    if (surface == NULL)
+        return NULL;
+
+    // The new surface is transparent, so the shadow only needs premultiplying
+    for (int y = 0; y < shadow->h && y + offset < surface->h; y++) {
+        const Uint32 *src = (const Uint32*) ((const Uint8*) shadow->pixels + y*shadow->pitch);
+        Uint32 *dst = (Uint32*) ((Uint8*) surface->pixels + (y + offset)*surface->pitch) + offset;
+        pixel_kernels->premultiply(src, dst, MIN(shadow->w, surface->w - offset));
+    }
+    for (int y = 0; y < foreground->h; y++) {
+        const Uint32 *src = (const Uint32*) ((const Uint8*) foreground->pixels + y*foreground->pitch);
+        Uint32 *dst = (Uint32*) ((Uint8*) surface->pixels + y*surface->pitch);
+        pixel_kernels->blend(src, dst, foreground->w);
+    }
+    return surface;
+}
@@ -0,0 +1,41 @@
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PIXELS_X86
+#endif
+#define LANCZOS_RADIUS 3.0F
+#define LANCZOS_PI 3.14159265F
+
+// Instruction sets with pixel kernels, in order of preference
+typedef enum {
+    PIXEL_ISA_SCALAR,
+    PIXEL_ISA_SSE2,
+    PIXEL_ISA_AVX2,
+    NUM_PIXEL_ISAS
+} PixelISA;
+
+// Resampling filter weights for one axis of an image
+typedef struct {
+    int *start; // First source pixel of each output pixel
+    int *count; // Number of source pixels of each output pixel
+    float *weights; // max_count weights for each output pixel
+    int max_count;
+} FilterWeights;
+
+// Kernels that work on a row of ARGB8888 pixels, or of pixels with
+// 4 float channels for resampling
+typedef struct {
+    const char *name;
+    void (*rgb24_to_argb)(const Uint8 *src, Uint32 *dst, int count);
+    void (*premultiply)(const Uint32 *src, Uint32 *dst, int count);
+    void (*blend)(const Uint32 *src, Uint32 *dst, int count);
+    void (*resample_row)(const float *src, float *dst, const FilterWeights *filter, int count);
+    void (*accumulate_row)(const float *src, float *dst, float weight, int count);
+} PixelKernels;
+
+const PixelKernels *init_pixel_kernels(void);
+const PixelKernels *get_pixel_kernels(PixelISA isa);
+bool calculate_filter_weights(FilterWeights *filter, int source, int output);
+void free_filter_weights(FilterWeights *filter);
+void resample_row(const float *src, float *dst, const FilterWeights *filter, int count);
+void accumulate_row(const float *src, float *dst, float weight, int count);
+void convert_rgb24_rows(const Uint8 *src, int src_pitch, Uint32 *dst, int dst_pitch, int w, int h);
+SDL_Surface *compose_text_shadow(SDL_Surface *foreground, SDL_Surface *shadow, int offset);
@@ -7,6 +7,10 @@
 // Abstracted platform function prototypes
 bool file_exists(const char *path);
 bool directory_exists(const char *path);
+void make_directory(const char *directory);
+bool get_file_info(const char *path, Uint64 *mtime, Uint64 *size);
+void *map_file(const char *path, size_t *size);
+void unmap_file(void *data, size_t size);
 void get_region(char *buffer);
 void scan_slideshow_directory(Slideshow *slideshow, const char *directory);
 bool start_process(char *cmd, bool application);
@@ -16,7 +20,6 @@ void scmd_sleep(void);
 
 // Linux-specific function prototypes
 #ifdef __unix__
-void make_directory(const char *directory);
 void print_usage(void);
 #endif
 
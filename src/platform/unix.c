@@ -4,6 +4,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <SDL.h>
 #include <ini.h>
@@ -42,6 +44,42 @@ bool directory_exists(const char *path)
     return stat(path, &directory) == 0 && S_ISDIR(directory.st_mode) ? true : false;
 }
 
+// A function to get the modification time and size of a file
+bool get_file_info(const char *path, Uint64 *mtime, Uint64 *size)
+{
+    struct stat file;
+    if (stat(path, &file))
+        return false;
+    *mtime = (Uint64) file.st_mtime;
+    *size = (Uint64) file.st_size;
+    return true;
+}
+
+// A function to map a file into memory for reading
+void *map_file(const char *path, size_t *size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat file;
+    void *data = NULL;
+    if (!fstat(fd, &file) && file.st_size > 0) {
+        data = mmap(NULL, (size_t) file.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+            data = NULL;
+        else
+            *size = (size_t) file.st_size;
+    }
+    close(fd);
+    return data;
+}
+
+// A function to unmap a file that was mapped into memory
+void unmap_file(void *data, size_t size)
+{
+    munmap(data, size);
+}
+
 // A function to remove field codes from .desktop file Exec line
 static void strip_field_codes(char *cmd)
 {
@@ -229,7 +267,19 @@ void scmd_sleep()
 void print_usage()
 {
     printf("Usage: " EXECUTABLE_TITLE " [OPTIONS]\n");
+    printf("  -b[n], --benchmark[=n]\n"
+           "                     Render n frames (default 1000) offscreen with a scripted\n"
+           "                     sequence of commands, then print timing results.\n");
+    printf("  --screenshot=p     Benchmark: save the last frame as a PNG file at path p.\n");
+    printf("  --reference=p      Benchmark: fail if the last frame differs from the PNG file at path p.\n");
+    printf("  --max-first-frame=ms\n"
+           "                     Benchmark: fail if the first frame takes longer than ms milliseconds.\n");
+    printf("  --max-draw=ms      Benchmark: fail if the mean draw time exceeds ms milliseconds.\n");
+    printf("  --time=t           Benchmark: show the time t, in seconds since 1970, on the clock.\n");
     printf("  -c p, --config=p   Load config file from path p.\n");
+    printf("  -p p, --compile-pack=p\n"
+           "                     Render every icon, title, highlight and scroll indicator\n"
+           "                     for the config into a theme pack at path p, then quit.\n");
     printf("  -d,   --debug      Enable debug messages.\n");
     printf("  -h,   --help       Show this help message.\n");
     printf("  -v,   --version    Print version information.\n");
@@ -46,6 +46,62 @@ bool directory_exists(const char *path)
     }
 }
 
+// A function to make a directory, including any intermediate
+// directories if necessary
+void make_directory(const char *directory)
+{
+    char buffer[MAX_PATH_CHARS + 1];
+    snprintf(buffer, sizeof(buffer), "%s", directory);
+    for (char *i = buffer + 1; *i != '\0'; i++) {
+        if (*i == '\\' || *i == '/') {
+            char c = *i;
+            *i = '\0';
+            CreateDirectoryA(buffer, NULL);
+            *i = c;
+        }
+    }
+    CreateDirectoryA(buffer, NULL);
+}
+
+// A function to get the modification time and size of a file
+bool get_file_info(const char *path, Uint64 *mtime, Uint64 *size)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+        return false;
+    *mtime = ((Uint64) data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+    *size = ((Uint64) data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    return true;
+}
+
+// A function to map a file into memory for reading
+void *map_file(const char *path, size_t *size)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+    void *data = NULL;
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL) {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (data != NULL)
+                *size = (size_t) file_size.QuadPart;
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+    return data;
+}
+
+// A function to unmap a file that was mapped into memory
+void unmap_file(void *data, size_t size)
+{
+    UNUSED(size);
+    UnmapViewOfFile(data);
+}
+
 // A function that parses the command string into a file and parameters
 static void parse_command(char *cmd, char *file, size_t file_size, char **params)
 {
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdbool.h>
+#include <SDL.h>
+#include "launcher.h"
+#include <launcher_config.h>
+#include "stats.h"
+#include "util.h"
+#include "debug.h"
+
+static void record_duration(Histogram *histogram, Uint64 duration);
+static Uint32 get_percentile(const Histogram *histogram, double percentile);
+static void output_line(FILE *stream, const char *format, ...);
+
+extern Config config;
+extern Uint32 refresh_period;
+static Histogram histograms[NUM_PHASES];
+static Uint64 frequency = 0;
+static Uint64 last_present = 0;
+static Uint64 dropped_frames = 0;
+static Histogram slideshow_decode;
+static Uint64 slideshow_depths[SLIDESHOW_PREFETCH_DEPTH + 1]; // Transitions by number of images ready when due
+static Uint64 slideshow_delay = 0; // Total milliseconds that transitions started late
+static const char *phase_names[NUM_PHASES] = {
+    "Events",
+    "Update",
+    "Draw",
+    "Present",
+    "Frame"
+};
+
+// A function to initialize the frame timing statistics
+void init_stats()
+{
+    memset(histograms, 0, sizeof(histograms));
+    frequency = SDL_GetPerformanceFrequency();
+    last_present = 0;
+    dropped_frames = 0;
+    memset(&slideshow_decode, 0, sizeof(slideshow_decode));
+    memset(slideshow_depths, 0, sizeof(slideshow_depths));
+    slideshow_delay = 0;
+}
+
+// A function to record the start time of a phase of the main loop
+void start_phase(Phase phase)
+{
+    if (!config.frame_stats)
+        return;
+    histograms[phase].start = SDL_GetPerformanceCounter();
+}
+
+// A function to record the duration of a phase of the main loop
+void end_phase(Phase phase)
+{
+    if (!config.frame_stats)
+        return;
+    Uint64 now = SDL_GetPerformanceCounter();
+    record_duration(&histograms[phase], now - histograms[phase].start);
+
+    // Measure the time between consecutive frames when a frame is presented
+    if (phase == PHASE_PRESENT) {
+        if (last_present) {
+            Uint64 interval = now - last_present;
+            record_duration(&histograms[PHASE_FRAME], interval);
+            if ((double) interval * 1000.0 > (double) refresh_period * (double) frequency * STATS_DROPPED_FRAME_FACTOR)
+                dropped_frames++;
+        }
+        last_present = now;
+    }
+}
+
+// A function to exclude the time until the next frame, e.g. when the main loop sleeps
+void skip_frame()
+{
+    last_present = 0;
+}
+
+// A function to record a slideshow transition: how long its image took to decode,
+// how many decoded images were ready when it was due, and how many milliseconds
+// it started late because none were
+void record_slideshow_image(Uint64 decode_time, int depth, Uint32 delay)
+{
+    if (!config.frame_stats)
+        return;
+    record_duration(&slideshow_decode, decode_time);
+    slideshow_depths[MIN(depth, SLIDESHOW_PREFETCH_DEPTH)]++;
+    slideshow_delay += delay;
+}
+
+// A function to add a duration in performance counter ticks to a histogram
+static void record_duration(Histogram *histogram, Uint64 duration)
+{
+    Uint32 us = (Uint32) MIN(duration * 1000000 / frequency, (Uint64) UINT32_MAX);
+    Uint32 bucket = MIN(us / STATS_BUCKET_WIDTH, STATS_NUM_BUCKETS - 1);
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->total += us;
+    if (us > histogram->max)
+        histogram->max = us;
+}
+
+// A function to estimate a percentile in microseconds from a histogram
+static Uint32 get_percentile(const Histogram *histogram, double percentile)
+{
+    Uint64 target = (Uint64) ((double) histogram->count * percentile + 0.5);
+    Uint64 count = 0;
+    for (Uint32 i = 0; i < STATS_NUM_BUCKETS; i++) {
+        count += histogram->buckets[i];
+        if (count >= target && count > 0)
+            return MIN((i + 1) * STATS_BUCKET_WIDTH, histogram->max);
+    }
+    return histogram->max;
+}
+
+// A function to get the mean duration of a phase in milliseconds
+double get_mean_duration(Phase phase)
+{
+    const Histogram *histogram = &histograms[phase];
+    if (histogram->count == 0)
+        return 0.0;
+    return (double) histogram->total / (double) histogram->count / 1000.0;
+}
+
+// A function to output a line of statistics to a stream, or to the log if NULL
+static void output_line(FILE *stream, const char *format, ...)
+{
+    char buffer[MAX_STATS_LINE_CHARS];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (stream == NULL)
+        log_info("%s", buffer);
+    else
+        fprintf(stream, "%s\n", buffer);
+}
+
+// A function to output the frame timing statistics to the log
+void log_stats()
+{
+    if (config.frame_stats) {
+        output_stats(NULL);
+        flush_log();
+    }
+}
+
+// A function to output the frame timing statistics to a stream, or to the log if NULL
+void output_stats(FILE *stream)
+{
+    output_line(stream, "=================== Frame Statistics ===================");
+    output_line(stream, "%-8s %8s %8s %8s %8s %8s %8s", "Phase", "Count", "Mean", "p50", "p95", "p99", "Max");
+    for (int i = 0; i < NUM_PHASES; i++) {
+        const Histogram *histogram = &histograms[i];
+        double mean = histogram->count ? (double) histogram->total / (double) histogram->count : 0.0;
+        output_line(stream, "%-8s %8llu %8.2f %8.2f %8.2f %8.2f %8.2f",
+            phase_names[i],
+            (unsigned long long) histogram->count,
+            mean / 1000.0,
+            (double) get_percentile(histogram, 0.50) / 1000.0,
+            (double) get_percentile(histogram, 0.95) / 1000.0,
+            (double) get_percentile(histogram, 0.99) / 1000.0,
+            (double) histogram->max / 1000.0
+        );
+    }
+    output_line(stream, "Times are in milliseconds");
+    output_line(stream, "Dropped frames: %llu", (unsigned long long) dropped_frames);
+    if (slideshow_decode.count == 0)
+        return;
+
+    // Slideshow prefetch statistics
+    output_line(stream, "================= Slideshow Statistics =================");
+    output_line(stream, "%-8s %8s %8s %8s %8s %8s %8s", "Phase", "Count", "Mean", "p50", "p95", "p99", "Max");
+    output_line(stream, "%-8s %8llu %8.2f %8.2f %8.2f %8.2f %8.2f",
+        "Decode",
+        (unsigned long long) slideshow_decode.count,
+        (double) slideshow_decode.total / (double) slideshow_decode.count / 1000.0,
+        (double) get_percentile(&slideshow_decode, 0.50) / 1000.0,
+        (double) get_percentile(&slideshow_decode, 0.95) / 1000.0,
+        (double) get_percentile(&slideshow_decode, 0.99) / 1000.0,
+        (double) slideshow_decode.max / 1000.0
+    );
+    for (int i = 0; i <= SLIDESHOW_PREFETCH_DEPTH; i++)
+        output_line(stream, "Images ready when due: %i, transitions: %llu", i, (unsigned long long) slideshow_depths[i]);
+    output_line(stream, "Late transitions: %llu, total delay: %llu ms",
+        (unsigned long long) slideshow_depths[0],
+        (unsigned long long) slideshow_delay
+    );
+}
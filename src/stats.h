@@ -0,0 +1,31 @@
+#define STATS_BUCKET_WIDTH 100 // Microseconds
+#define STATS_NUM_BUCKETS 1000
+#define STATS_DROPPED_FRAME_FACTOR 1.5
+#define MAX_STATS_LINE_CHARS 100
+
+typedef enum {
+    PHASE_EVENTS,
+    PHASE_UPDATE,
+    PHASE_DRAW,
+    PHASE_PRESENT,
+    PHASE_FRAME,
+    NUM_PHASES
+} Phase;
+
+// Histogram of the durations of a phase of the main loop
+typedef struct {
+    Uint32 buckets[STATS_NUM_BUCKETS];
+    Uint64 count;
+    Uint64 total;
+    Uint32 max;
+    Uint64 start;
+} Histogram;
+
+void init_stats(void);
+void start_phase(Phase phase);
+void end_phase(Phase phase);
+void skip_frame(void);
+void record_slideshow_image(Uint64 decode_time, int depth, Uint32 delay);
+void log_stats(void);
+void output_stats(FILE *stream);
+double get_mean_duration(Phase phase);
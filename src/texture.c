@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <SDL.h>
+#include "launcher.h"
+#include "texture.h"
+#include "atlas.h"
+#include "pixels.h"
+#include "util.h"
+#include "debug.h"
+
+static Uint64 get_texture_size(SDL_Texture *texture);
+static IconAtlas *create_icon_atlas(void);
+static IconAtlas *get_icon_slot(int *slot);
+
+extern Config config;
+extern SDL_Renderer *renderer;
+
+// Total size of all textures created by the launcher
+static Uint64 texture_memory = 0;
+static SharedTexture *shared_textures = NULL;
+static IconAtlas *icon_atlases = NULL;
+
+// A function to estimate the memory used by a texture
+static Uint64 get_texture_size(SDL_Texture *texture)
+{
+    Uint32 format;
+    int w, h;
+    if (SDL_QueryTexture(texture, &format, NULL, &w, &h))
+        return 0;
+    int bytes_per_pixel = SDL_ISPIXELFORMAT_FOURCC(format) ? 4 : SDL_BYTESPERPIXEL(format);
+    return (Uint64) w * (Uint64) h * (Uint64) bytes_per_pixel;
+}
+
+// A function to create a texture and account for its memory
+SDL_Texture *create_texture(Uint32 format, int access, int w, int h)
+{
+    SDL_Texture *texture = SDL_CreateTexture(renderer, format, access, w, h);
+    if (texture != NULL)
+        texture_memory += get_texture_size(texture);
+    return texture;
+}
+
+// A function to create a texture from a surface and account for its memory
+SDL_Texture *create_texture_from_surface(SDL_Surface *surface)
+{
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (texture != NULL)
+        texture_memory += get_texture_size(texture);
+    return texture;
+}
+
+// A function to create a texture that is updated in place from surfaces
+// instead of being recreated each time its contents change
+SDL_Texture *create_streaming_texture(int w, int h)
+{
+    SDL_Texture *texture = create_texture(STREAMING_TEXTURE_FORMAT, SDL_TEXTUREACCESS_STREAMING, w, h);
+    if (texture == NULL)
+        log_error("Could not create texture %s", SDL_GetError());
+    else
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return texture;
+}
+
+// A function to copy a surface into a streaming texture. A surface larger than
+// the texture is cropped around its center, and rect is set to the area of the
+// texture that was written. The surface is freed
+bool update_streaming_texture(SDL_Texture *texture, SDL_Surface *surface, SDL_Rect *rect)
+{
+    if (surface == NULL)
+        return false;
+    if (texture == NULL) {
+        SDL_FreeSurface(surface);
+        return false;
+    }
+
+    // Indexed images can't be converted row by row, so expand them first
+    if (SDL_ISPIXELFORMAT_INDEXED(surface->format->format)) {
+        SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, STREAMING_TEXTURE_FORMAT, 0);
+        SDL_FreeSurface(surface);
+        if (converted == NULL)
+            return false;
+        surface = converted;
+    }
+
+    int w, h;
+    SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+    *rect = (SDL_Rect) {0, 0, MIN(surface->w, w), MIN(surface->h, h)};
+    int x = (surface->w - rect->w) / 2;
+    int y = (surface->h - rect->h) / 2;
+    void *pixels;
+    int pitch;
+    bool success = false;
+    if (SDL_LockTexture(texture, rect, &pixels, &pitch))
+        log_error("Could not update texture %s", SDL_GetError());
+    else {
+        if (SDL_MUSTLOCK(surface))
+            SDL_LockSurface(surface);
+        const Uint8 *source = (const Uint8*) surface->pixels + y*surface->pitch + x*surface->format->BytesPerPixel;
+
+        // JPEG images are expanded with the SIMD kernels, everything else by SDL
+        if (surface->format->format == SDL_PIXELFORMAT_RGB24 && STREAMING_TEXTURE_FORMAT == SDL_PIXELFORMAT_ARGB8888) {
+            convert_rgb24_rows(source, surface->pitch, pixels, pitch, rect->w, rect->h);
+            success = true;
+        }
+        else {
+            success = !SDL_ConvertPixels(rect->w,
+                          rect->h,
+                          surface->format->format,
+                          source,
+                          surface->pitch,
+                          STREAMING_TEXTURE_FORMAT,
+                          pixels,
+                          pitch
+                      );
+        }
+        if (SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+        SDL_UnlockTexture(texture);
+    }
+    SDL_FreeSurface(surface);
+    return success;
+}
+
+// A function to destroy a texture and release its memory from the total
+void destroy_texture(SDL_Texture *texture)
+{
+    if (texture == NULL)
+        return;
+    Uint64 size = get_texture_size(texture);
+    texture_memory = size > texture_memory ? 0 : texture_memory - size;
+    SDL_DestroyTexture(texture);
+}
+
+// A function to get the total memory used by textures
+Uint64 get_texture_memory()
+{
+    return texture_memory;
+}
+
+// A function to check if the textures use more memory than the texture budget
+bool over_texture_budget()
+{
+    return config.texture_budget > 0 && texture_memory > config.texture_budget;
+}
+
+// A function to get the shared texture for an image file, adding a reference to it.
+// If the image has not been loaded yet, created is set and the caller must load it
+SharedTexture *acquire_shared_texture(const char *path, bool *created)
+{
+    SharedTexture *shared;
+    for (shared = shared_textures; shared != NULL; shared = shared->next) {
+        if (!strcmp(shared->path, path))
+            break;
+    }
+    *created = shared == NULL;
+    if (shared == NULL) {
+        shared = malloc(sizeof(SharedTexture));
+        *shared = (SharedTexture) {
+            .path = strdup(path),
+            .texture = NULL,
+            .clip = {0, 0, 0, 0},
+            .atlas = NULL,
+            .slot = -1,
+            .references = 0,
+            .loader = NULL,
+            .next = shared_textures
+        };
+        shared_textures = shared;
+    }
+    shared->references++;
+    return shared;
+}
+
+// A function to create an empty icon atlas, sized to hold a grid of icons
+// that fits in the maximum texture size of the renderer
+static IconAtlas *create_icon_atlas()
+{
+    int max_width = ATLAS_MAX_SIZE;
+    int max_height = ATLAS_MAX_SIZE;
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        if (info.max_texture_width > 0)
+            max_width = MIN(max_width, info.max_texture_width);
+        if (info.max_texture_height > 0)
+            max_height = MIN(max_height, info.max_texture_height);
+    }
+    int cell = config.icon_size + ATLAS_PADDING;
+    int columns = MIN(ICON_ATLAS_COLUMNS, max_width / cell);
+    int rows = MIN(ICON_ATLAS_ROWS, max_height / cell);
+    if (columns == 0 || rows == 0)
+        return NULL;
+
+    // Clear the atlas, so the padding between the icons is transparent
+    int width = columns * cell;
+    int height = rows * cell;
+    Uint32 *pixels = calloc((size_t) width * (size_t) height, sizeof(Uint32));
+    IconAtlas *atlas = malloc(sizeof(IconAtlas));
+    bool *slots = calloc((size_t) (columns * rows), sizeof(bool));
+    SDL_Texture *texture = NULL;
+    if (pixels != NULL && atlas != NULL && slots != NULL)
+        texture = create_texture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+    if (texture == NULL) {
+        free(pixels);
+        free(atlas);
+        free(slots);
+        return NULL;
+    }
+    SDL_UpdateTexture(texture, NULL, pixels, width * (int) sizeof(Uint32));
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    free(pixels);
+    *atlas = (IconAtlas) {
+        .texture = texture,
+        .columns = columns,
+        .rows = rows,
+        .used = 0,
+        .slots = slots,
+        .next = icon_atlases
+    };
+    icon_atlases = atlas;
+    log_debug("Created %ix%i icon atlas", columns, rows);
+    return atlas;
+}
+
+// A function to find a free slot in the icon atlases, creating an atlas if every one is full
+static IconAtlas *get_icon_slot(int *slot)
+{
+    IconAtlas *atlas;
+    for (atlas = icon_atlases; atlas != NULL; atlas = atlas->next) {
+        if (atlas->used < atlas->columns * atlas->rows)
+            break;
+    }
+    if (atlas == NULL && (atlas = create_icon_atlas()) == NULL)
+        return NULL;
+    for (*slot = 0; atlas->slots[*slot]; (*slot)++);
+    atlas->slots[*slot] = true;
+    atlas->used++;
+    return atlas;
+}
+
+// A function to upload a decoded image to its shared texture. Icons are copied into
+// a slot of an icon atlas, and larger images get their own texture. The surface is freed
+SDL_Texture *upload_shared_texture(SharedTexture *shared, SDL_Surface *surface)
+{
+    if (surface == NULL)
+        return NULL;
+    int slot;
+    IconAtlas *atlas = NULL;
+    if (surface->w <= config.icon_size && surface->h <= config.icon_size)
+        atlas = get_icon_slot(&slot);
+    if (atlas == NULL) {
+        shared->texture = create_texture_from_surface(surface);
+        if (shared->texture == NULL)
+            log_error("Could not create texture %s", SDL_GetError());
+        SDL_FreeSurface(surface);
+        shared->clip = (SDL_Rect) {0, 0, 0, 0};
+        if (shared->texture != NULL)
+            SDL_QueryTexture(shared->texture, NULL, NULL, &shared->clip.w, &shared->clip.h);
+        return shared->texture;
+    }
+
+    // Copy the image into the slot
+    int cell = config.icon_size + ATLAS_PADDING;
+    SDL_Rect clip = {(slot % atlas->columns) * cell, (slot / atlas->columns) * cell, surface->w, surface->h};
+    SDL_Surface *converted = surface;
+    if (surface->format->format != SDL_PIXELFORMAT_ARGB8888)
+        converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (converted == NULL || SDL_UpdateTexture(atlas->texture, &clip, converted->pixels, converted->pitch)) {
+        log_error("Could not update icon atlas %s", SDL_GetError());
+        atlas->slots[slot] = false;
+        atlas->used--;
+        clip = (SDL_Rect) {0, 0, 0, 0};
+        atlas = NULL;
+    }
+    if (converted != surface)
+        SDL_FreeSurface(converted);
+    SDL_FreeSurface(surface);
+    shared->atlas = atlas;
+    shared->slot = atlas != NULL ? slot : -1;
+    shared->texture = atlas != NULL ? atlas->texture : NULL;
+    shared->clip = clip;
+    return shared->texture;
+}
+
+// A function to remove a reference to a shared texture, destroying it
+// when no entries use it anymore
+void release_shared_texture(SharedTexture *shared)
+{
+    if (shared == NULL || --shared->references > 0)
+        return;
+    SharedTexture **link = &shared_textures;
+    while (*link != shared)
+        link = &(*link)->next;
+    *link = shared->next;
+
+    // Free the atlas slot, and the atlas once it holds no icons
+    IconAtlas *atlas = shared->atlas;
+    if (atlas != NULL) {
+        atlas->slots[shared->slot] = false;
+        if (--atlas->used == 0) {
+            IconAtlas **atlas_link = &icon_atlases;
+            while (*atlas_link != atlas)
+                atlas_link = &(*atlas_link)->next;
+            *atlas_link = atlas->next;
+            destroy_texture(atlas->texture);
+            free(atlas->slots);
+            free(atlas);
+        }
+    }
+    else
+        destroy_texture(shared->texture);
+    free(shared->path);
+    free(shared);
+}
+
+// A function to write the memory used by shared textures to the log
+void log_shared_textures()
+{
+    int count = 0;
+    int references = 0;
+    Uint64 memory = 0;
+    int atlases = 0;
+    for (SharedTexture *shared = shared_textures; shared != NULL; shared = shared->next) {
+        count++;
+        references += shared->references;
+        if (shared->texture != NULL && shared->atlas == NULL)
+            memory += get_texture_size(shared->texture);
+    }
+    for (IconAtlas *atlas = icon_atlases; atlas != NULL; atlas = atlas->next) {
+        atlases++;
+        memory += get_texture_size(atlas->texture);
+    }
+    log_debug("Shared textures: %i images used by %i entries in %i atlases, %" PRIu64 " KB; all textures: %" PRIu64 " KB",
+        count,
+        references,
+        atlases,
+        memory / 1024,
+        texture_memory / 1024
+    );
+}
+
+// A function to free the lists of shared textures and icon atlases
+void free_shared_textures()
+{
+    SharedTexture *shared = shared_textures;
+    while (shared != NULL) {
+        SharedTexture *next = shared->next;
+        free(shared->path);
+        free(shared);
+        shared = next;
+    }
+    shared_textures = NULL;
+    IconAtlas *atlas = icon_atlases;
+    while (atlas != NULL) {
+        IconAtlas *next = atlas->next;
+        free(atlas->slots);
+        free(atlas);
+        atlas = next;
+    }
+    icon_atlases = NULL;
+}
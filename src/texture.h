@@ -0,0 +1,16 @@
+#define STREAMING_TEXTURE_FORMAT SDL_PIXELFORMAT_ARGB8888
+#define ICON_ATLAS_COLUMNS 4
+#define ICON_ATLAS_ROWS 2
+
+SDL_Texture *create_texture(Uint32 format, int access, int w, int h);
+SDL_Texture *create_texture_from_surface(SDL_Surface *surface);
+SDL_Texture *create_streaming_texture(int w, int h);
+bool update_streaming_texture(SDL_Texture *texture, SDL_Surface *surface, SDL_Rect *rect);
+void destroy_texture(SDL_Texture *texture);
+Uint64 get_texture_memory(void);
+bool over_texture_budget(void);
+SharedTexture *acquire_shared_texture(const char *path, bool *created);
+SDL_Texture *upload_shared_texture(SharedTexture *shared, SDL_Surface *surface);
+void release_shared_texture(SharedTexture *shared);
+void log_shared_textures(void);
+void free_shared_textures(void);
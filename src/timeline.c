@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <SDL.h>
+#include "launcher.h"
+#include "timeline.h"
+
+// Timeline sampled once per frame from the high resolution counter
+typedef struct {
+    Uint64 frequency;
+    Uint64 now;
+} Timeline;
+
+static Timeline timeline = {
+    .frequency = 1,
+    .now = 0
+};
+
+// A function to initialize the animation timeline
+void init_timeline()
+{
+    timeline.frequency = SDL_GetPerformanceFrequency();
+    timeline.now = SDL_GetPerformanceCounter();
+}
+
+// A function to sample the current time, so that all animations in a frame see the same time
+void update_timeline()
+{
+    timeline.now = SDL_GetPerformanceCounter();
+}
+
+// A function to get the time of the current frame
+Uint64 get_timeline_time()
+{
+    return timeline.now;
+}
+
+// A function to convert a duration in milliseconds to counter ticks
+Uint64 ms_to_counter(Uint32 ms)
+{
+    return (Uint64) ms * timeline.frequency / 1000;
+}
+
+// A function to get the number of milliseconds from the current frame until a time,
+// rounded up so that a wait of that length doesn't wake up early
+Uint32 get_time_until(Uint64 time)
+{
+    if (time <= timeline.now)
+        return 0;
+    return (Uint32) (((time - timeline.now) * 1000 + timeline.frequency - 1) / timeline.frequency);
+}
+
+// A function to start an animation at the time of the current frame
+void start_animation(Animation *animation, Uint32 duration)
+{
+    animation->start = timeline.now;
+    animation->duration = ms_to_counter(duration);
+}
+
+// A function to get the progress of an animation from 0 to 1
+float get_animation_progress(const Animation *animation)
+{
+    if (animation->duration == 0 || timeline.now >= animation->start + animation->duration)
+        return 1.0f;
+    return (float) ((double) (timeline.now - animation->start) / (double) animation->duration);
+}
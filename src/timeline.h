@@ -0,0 +1,7 @@
+void init_timeline(void);
+void update_timeline(void);
+Uint64 get_timeline_time(void);
+Uint64 ms_to_counter(Uint32 ms);
+Uint32 get_time_until(Uint64 time);
+void start_animation(Animation *animation, Uint32 duration);
+float get_animation_progress(const Animation *animation);
@@ -41,12 +41,19 @@ void handle_arguments(int argc, char *argv[], char **config_file_path)
         bool version = false;
         bool help = false;
         int rc;
-        const char *short_opts = "hvc:d";
+        const char *short_opts = "hvc:db::p:";
         static const struct option long_opts[] = {
             { "help",         no_argument,       NULL, 'h' },
             { "version",      no_argument,       NULL, 'v' },
             { "config",       required_argument, NULL, 'c' },
             { "debug",        no_argument,       NULL, 'd' },
+            { "benchmark",    optional_argument, NULL, 'b' },
+            { "screenshot",   required_argument, NULL, 's' },
+            { "reference",    required_argument, NULL, 'r' },
+            { "max-first-frame", required_argument, NULL, 'f' },
+            { "max-draw",     required_argument, NULL, 't' },
+            { "compile-pack", required_argument, NULL, 'p' },
+            { "time",         required_argument, NULL, 'T' },
             { 0, 0, 0, 0 }
         };
     
@@ -70,6 +77,43 @@ void handle_arguments(int argc, char *argv[], char **config_file_path)
                 case 'd':
                     config.debug = true;
                     break;
+
+                case 'b':
+                    config.benchmark = true;
+                    if (optarg != NULL)
+                        config.benchmark_frames = atoi(optarg);
+                    break;
+
+                case 's':
+                    free(config.benchmark_screenshot);
+                    config.benchmark_screenshot = strdup(optarg);
+                    break;
+
+                case 'r':
+                    if (file_exists(optarg)) {
+                        free(config.benchmark_reference);
+                        config.benchmark_reference = strdup(optarg);
+                    }
+                    else
+                        log_fatal("Reference image '%s' not found", optarg);
+                    break;
+
+                case 'f':
+                    config.benchmark_max_first_frame = atof(optarg);
+                    break;
+
+                case 't':
+                    config.benchmark_max_draw = atof(optarg);
+                    break;
+
+                case 'T':
+                    config.benchmark_time = strtoll(optarg, NULL, 10);
+                    break;
+
+                case 'p':
+                    free(config.compile_pack);
+                    config.compile_pack = strdup(optarg);
+                    break;
             }
         }
 
@@ -139,6 +183,8 @@ int config_handler(void *user, const char *section, const char *name, const char
             if (fps > MIN_FPS_LIMIT)
                 config.fps_limit = fps;
         }
+        else if (MATCH(name, SETTING_PRECISE_FRAME_PACING))
+            convert_bool(value, &config.precise_frame_pacing);
         else if (MATCH(name, SETTING_APPLICATION_TIMEOUT)) {
             Uint32 application_timeout = (Uint32) atoi(value);
             if (application_timeout >= MIN_APPLICATION_TIMEOUT
@@ -146,6 +192,27 @@ int config_handler(void *user, const char *section, const char *name, const char
                 config.application_timeout = 1000 * application_timeout;
             }
         }
+        else if (MATCH(name, SETTING_LOW_POWER_MODE))
+            convert_bool(value, &config.low_power_mode);
+        else if (MATCH(name, SETTING_ICON_CACHE))
+            convert_bool(value, &config.icon_cache);
+        else if (MATCH(name, SETTING_TEXTURE_BUDGET)) {
+            int texture_budget = atoi(value);
+            if (texture_budget >= 0)
+                config.texture_budget = (Uint64) texture_budget * 1024 * 1024;
+        }
+        else if (MATCH(name, SETTING_THEME_PACK)) {
+            free(config.theme_pack);
+            config.theme_pack = strdup(value);
+            clean_path(config.theme_pack);
+        }
+        else if (MATCH(name, SETTING_IDLE_FPS)) {
+            int idle_fps = atoi(value);
+            if (idle_fps >= 0 && idle_fps <= MAX_IDLE_FPS)
+                config.idle_fps = idle_fps;
+        }
+        else if (MATCH(name, SETTING_FRAME_STATS))
+            convert_bool(value, &config.frame_stats);
         else if (MATCH(name, SETTING_ON_LAUNCH))
             parse_mode_setting(MODE_SETTING_ON_LAUNCH, value, (int*) &config.on_launch);
         else if (MATCH(name, SETTING_WRAP_ENTRIES))
@@ -440,6 +507,8 @@ int config_handler(void *user, const char *section, const char *name, const char
                 entry->next = NULL;
             }
             entry->title_offset = 0;
+            entry->icon_shared = NULL;
+            entry->icon_selected_shared = NULL;
         }
 
         // Store data in entry struct
@@ -751,7 +820,8 @@ void random_array(int *array, int array_size)
         array[i] = i;
 
     // Shuffle array indices randomly, see https://en.wikipedia.org/wiki/Fisher%E2%80%93Yates_shuffle
-    srand((unsigned int) time(NULL));
+    // The order is fixed in benchmark mode so that the output can be compared
+    srand(config.benchmark ? 1 : (unsigned int) time(NULL));
     int tmp;
     for (int i = 0; i < array_size - 1; i++) {
         int j = (rand() % (array_size - i)) + i;
@@ -898,6 +968,12 @@ void validate_settings(Geometry *geo)
     if (!config.titles_enabled)
         config.title_padding = 0;
 
+    // Idle frames are only skipped in low power mode, so the idle frame rate has no effect without it
+    if (config.idle_fps > 0 && !config.low_power_mode) {
+        log_error("%s requires %s, ignoring it", SETTING_IDLE_FPS, SETTING_LOW_POWER_MODE);
+        config.idle_fps = 0;
+    }
+
     // Convert % opacity settings to 0-255
     if (config.title_opacity[0] != '\0') {
         int title_opacity = INVALID_PERCENT_VALUE;
@@ -1065,7 +1141,9 @@ Menu *create_menu(const char *menu_name, size_t *num_menus)
         .num_entries = 0,
         .page = 0,
         .highlight_position = 0,
-        .rendered = false
+        .pages = NULL,
+        .num_pages = 0,
+        .last_shown = 0
     };
     menu->name = strdup(menu_name);
     (*num_menus)++;
@@ -1087,6 +1165,18 @@ Entry *advance_entries(Entry *entry, int spaces, Direction direction)
     return entry;
 }
 
+// A function to get the first entry on a page of a menu
+Entry *get_page_entry(Menu *menu, unsigned int page)
+{
+    return advance_entries(menu->first_entry, (int) (page * config.max_buttons), DIRECTION_RIGHT);
+}
+
+// A function to get the number of entries on a page of a menu
+unsigned int get_page_entries(Menu *menu, unsigned int page)
+{
+    return MIN(config.max_buttons, menu->num_entries - page * config.max_buttons);
+}
+
 // A function to dynamically allocate a buffer for and copy a formatted string
 void sprintf_alloc(char **buffer, const char *format, ...)
 {
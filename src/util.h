@@ -15,6 +15,7 @@
 
 #define DIV_ROUND_UP(a, b) ((a + (b - 1)) / b)
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
 
 struct gamepad_info {
     const char *label;
@@ -46,4 +47,6 @@ void read_file(const char *path, char **buffer);
 void sprintf_alloc(char **buffer, const char *format, ...);
 Uint16 get_unicode_code_point(const char *p, int *bytes);
 Menu *get_menu(const char *menu_name);
-Entry *advance_entries(Entry *entry, int spaces, Direction direction);
\ No newline at end of file
+Entry *advance_entries(Entry *entry, int spaces, Direction direction);
+Entry *get_page_entry(Menu *menu, unsigned int page);
+unsigned int get_page_entries(Menu *menu, unsigned int page);
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include "pixels.h"
+
+#define ROW_LENGTH 1923 // Not a multiple of any vector width, so the scalar tails run too
+#define ROWS 64
+#define ITERATIONS 20
+#define RESAMPLE_FACTOR 3
+
+// Pixel operations checked by the test
+typedef enum {
+    OP_RGB24_TO_ARGB,
+    OP_PREMULTIPLY,
+    OP_BLEND,
+    OP_RESAMPLE_ROW,
+    OP_ACCUMULATE_ROW,
+    NUM_OPS
+} Operation;
+
+// Inputs of the operations
+typedef struct {
+    Uint8 *rgb24;
+    Uint32 *argb;
+    Uint32 *background;
+    float *floats;
+    FilterWeights filter;
+} TestData;
+
+static void fill_random(Uint8 *buffer, size_t size, Uint32 seed);
+static bool init_test_data(TestData *data);
+static void run_operation(Operation operation, const PixelKernels *kernels, TestData *data, Uint8 *output, size_t row_size);
+
+static const char *operation_names[] = {
+    "RGB24>ARGB",
+    "Premult",
+    "Blend",
+    "Resample",
+    "Accumulate"
+};
+
+// A function to fill a buffer with pseudorandom bytes
+static void fill_random(Uint8 *buffer, size_t size, Uint32 seed)
+{
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1664525 + 1013904223;
+        buffer[i] = (Uint8) (seed >> 24);
+    }
+}
+
+// A function to create the rows of test pixels. A quarter of the ARGB8888 pixels
+// are fully transparent or opaque so that the blend fast paths are exercised too
+static bool init_test_data(TestData *data)
+{
+    size_t pixels = (size_t) ROW_LENGTH * ROWS;
+    data->rgb24 = malloc(pixels * 3);
+    data->argb = malloc(pixels * sizeof(Uint32));
+    data->background = malloc(pixels * sizeof(Uint32));
+    data->floats = malloc(pixels * 4 * sizeof(float));
+    if (data->rgb24 == NULL || data->argb == NULL || data->background == NULL || data->floats == NULL)
+        return false;
+    fill_random(data->rgb24, pixels * 3, 1);
+    fill_random((Uint8*) data->argb, pixels * sizeof(Uint32), 2);
+    fill_random((Uint8*) data->background, pixels * sizeof(Uint32), 3);
+    for (size_t i = 0; i < pixels; i++) {
+        if (i % 8 == 0)
+            data->argb[i] |= 0xFF000000;
+        else if (i % 8 == 1)
+            data->argb[i] &= 0x00FFFFFF;
+        for (int c = 0; c < 4; c++)
+            data->floats[4*i + c] = (float) (data->argb[i] >> (8*c) & 0xFF);
+    }
+    return calculate_filter_weights(&data->filter, ROW_LENGTH, ROW_LENGTH / RESAMPLE_FACTOR);
+}
+
+// A function to run an operation over every row of the test data
+static void run_operation(Operation operation, const PixelKernels *kernels, TestData *data, Uint8 *output, size_t row_size)
+{
+    for (int y = 0; y < ROWS; y++) {
+        Uint32 *dst = (Uint32*) (output + (size_t) y * row_size);
+        const Uint32 *argb = data->argb + y*ROW_LENGTH;
+        const float *floats = data->floats + y*ROW_LENGTH*4;
+        switch (operation) {
+            case OP_RGB24_TO_ARGB:
+                kernels->rgb24_to_argb(data->rgb24 + y*ROW_LENGTH*3, dst, ROW_LENGTH);
+                break;
+
+            case OP_PREMULTIPLY:
+                kernels->premultiply(argb, dst, ROW_LENGTH);
+                break;
+
+            case OP_BLEND:
+                memcpy(dst, data->background + y*ROW_LENGTH, ROW_LENGTH * sizeof(Uint32));
+                kernels->blend(argb, dst, ROW_LENGTH);
+                break;
+
+            case OP_RESAMPLE_ROW:
+                kernels->resample_row(floats, (float*) dst, &data->filter, ROW_LENGTH / RESAMPLE_FACTOR);
+                break;
+
+            case OP_ACCUMULATE_ROW:
+                memset(dst, 0, row_size);
+                kernels->accumulate_row(floats, (float*) dst, (float) (y % 7) / 7.0F, ROW_LENGTH * 4);
+                kernels->accumulate_row(data->floats + ROW_LENGTH*4*((y + 1) % ROWS), (float*) dst, 0.5F, ROW_LENGTH * 4);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+// A program to time the pixel kernels of every instruction set the CPU supports,
+// and check that they give exactly the same result as the scalar kernels
+int main(int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    const PixelKernels *selected = init_pixel_kernels();
+    TestData data;
+    size_t row_size = (size_t) ROW_LENGTH * 4 * sizeof(float);
+    Uint8 *expected = calloc(ROWS, row_size);
+    Uint8 *output = calloc(ROWS, row_size);
+    if (!init_test_data(&data) || expected == NULL || output == NULL) {
+        fprintf(stderr, "Could not allocate test data\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Selected %s kernels\n", selected->name);
+    printf("%-12s", "Operation");
+    for (PixelISA isa = PIXEL_ISA_SCALAR; isa < NUM_PIXEL_ISAS; isa++) {
+        if (get_pixel_kernels(isa) != NULL)
+            printf(" %9s", get_pixel_kernels(isa)->name);
+    }
+    printf("\n");
+
+    bool mismatch = false;
+    double frequency = (double) SDL_GetPerformanceFrequency();
+    double megapixels = (double) ROW_LENGTH * ROWS * ITERATIONS / 1000000.0;
+    for (Operation operation = 0; operation < NUM_OPS; operation++) {
+        printf("%-12s", operation_names[operation]);
+        memset(expected, 0, ROWS * row_size);
+        run_operation(operation, get_pixel_kernels(PIXEL_ISA_SCALAR), &data, expected, row_size);
+        for (PixelISA isa = PIXEL_ISA_SCALAR; isa < NUM_PIXEL_ISAS; isa++) {
+            const PixelKernels *kernels = get_pixel_kernels(isa);
+            if (kernels == NULL)
+                continue;
+            memset(output, 0, ROWS * row_size);
+            Uint64 start = SDL_GetPerformanceCounter();
+            for (int i = 0; i < ITERATIONS; i++)
+                run_operation(operation, kernels, &data, output, row_size);
+            double elapsed = (double) (SDL_GetPerformanceCounter() - start) / frequency;
+            printf(" %9.1f", elapsed > 0.0 ? megapixels / elapsed : 0.0);
+            if (memcmp(output, expected, ROWS * row_size)) {
+                fprintf(stderr, "\nFAIL: %s %s kernel does not match the scalar kernel\n",
+                    kernels->name,
+                    operation_names[operation]
+                );
+                mismatch = true;
+            }
+        }
+        printf("\n");
+    }
+    printf("Throughput in megapixels per second\n");
+
+    free_filter_weights(&data.filter);
+    free(data.rgb24);
+    free(data.argb);
+    free(data.background);
+    free(data.floats);
+    free(expected);
+    free(output);
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}